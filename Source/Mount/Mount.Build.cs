@@ -44,7 +44,15 @@ public class Mount : ModuleRules
 				"SlateCore",
 				"LevelEditor",
                 "DesktopPlatform",
-                "Sockets"
+                "Sockets",
+				"AssetRegistry",
+				"ImageWrapper",
+				"Json",
+				"MeshDescription",
+				"StaticMeshDescription",
+				"ContentBrowser",
+				"AssetTools",
+				"AlembicLibrary"
 				// ... add private dependencies that you statically link with here ...	
 			}
             );
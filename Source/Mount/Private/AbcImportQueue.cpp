@@ -0,0 +1,230 @@
+#include "AbcImportQueue.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "Editor.h"
+#include "FileHelpers.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "PackageTools.h"
+#include "Subsystems/ImportSubsystem.h"
+#include "Utilities.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+namespace
+{
+	// Pull the file through the OS cache so the importer's reads don't wait on disk/network
+	void warmFile(const FString& fileName, const TAtomic<bool>& bCancelled)
+	{
+		TUniquePtr<IFileHandle> handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*fileName));
+		if (!handle) return;
+
+		TArray<uint8> buffer;
+		buffer.SetNumUninitialized(4 * 1024 * 1024);
+		int64 remaining = handle->Size();
+		while (remaining > 0 && !bCancelled)
+		{
+			const int64 chunk = FMath::Min<int64>(remaining, buffer.Num());
+			if (!handle->Read(buffer.GetData(), chunk)) break;
+			remaining -= chunk;
+		}
+	}
+}
+
+TSharedPtr<AbcImportQueue> AbcImportQueue::Start(const TArray<FString>& fileNames, const AbcImportSettings& settings)
+{
+	if (fileNames.Num() == 0) return nullptr;
+
+	TSharedPtr<AbcImportQueue> queue = MakeShared<AbcImportQueue>(fileNames, settings);
+	queue->start();
+	return queue;
+}
+
+AbcImportQueue::AbcImportQueue(const TArray<FString>& fileNames, const AbcImportSettings& settings)
+	: mSettings(settings)
+	, mFiles(fileNames)
+	, mWarmed(false, fileNames.Num())
+{
+	mFileSizes.Reserve(mFiles.Num());
+	for (const FString& file : mFiles)
+	{
+		mFileSizes.Add(FMath::Max<int64>(IFileManager::Get().FileSize(*file), 0));
+	}
+}
+
+AbcImportQueue::~AbcImportQueue()
+{
+	bCancelled = true;
+	for (TFuture<void>& task : mReadAheadTasks)
+	{
+		task.Wait();
+	}
+}
+
+void AbcImportQueue::start()
+{
+	mStartTime = FPlatformTime::Seconds();
+	mBaseUsedBytes = FPlatformMemory::GetStats().UsedPhysical;
+
+	if (GEditor)
+	{
+		mPostImportHandle = GEditor->GetEditorSubsystem<UImportSubsystem>()->OnAssetPostImport.AddSP(this, &AbcImportQueue::onAssetPostImport);
+	}
+
+	FNotificationInfo info(FText::Format(LOCTEXT("AbcImportStart", "Importing {0} Alembic files"), FText::AsNumber(mFiles.Num())));
+	info.bFireAndForget = false;
+	info.ButtonDetails.Add(FNotificationButtonInfo(
+		LOCTEXT("AbcImportCancel", "Cancel"),
+		LOCTEXT("AbcImportCancelTip", "Stop after the current file, already imported files are kept"),
+		FSimpleDelegate::CreateSP(this, &AbcImportQueue::Cancel),
+		SNotificationItem::CS_Pending
+	));
+	TSharedPtr<SNotificationItem> item = FSlateNotificationManager::Get().AddNotification(info);
+	if (item.IsValid())
+	{
+		item->SetCompletionState(SNotificationItem::CS_Pending);
+	}
+	mNotification = item;
+
+	// One file per frame keeps the editor responsive between imports
+	TSharedRef<AbcImportQueue> self = AsShared();
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([self](float DeltaTime) {
+		return self->tick(DeltaTime);
+	}));
+}
+
+bool AbcImportQueue::tick(float DeltaTime)
+{
+	if (bCancelled || mCursor >= mFiles.Num())
+	{
+		finish();
+		return false;
+	}
+
+	scheduleReadAhead();
+	importNext();
+
+	const uint64 used = FPlatformMemory::GetStats().UsedPhysical;
+	const uint64 held = used > mBaseUsedBytes ? used - mBaseUsedBytes : 0;
+	mPeakHeldBytes = FMath::Max(mPeakHeldBytes, held);
+	if (mSinceFlush >= mSettings.FlushInterval || held > mSettings.MemoryBudgetBytes)
+	{
+		flushImported();
+	}
+
+	updateNotification();
+	return true;
+}
+
+void AbcImportQueue::scheduleReadAhead()
+{
+	mReadAheadTasks.RemoveAll([](const TFuture<void>& task) { return task.IsReady(); });
+
+	if (mReadAheadCursor <= mCursor)
+	{
+		mReadAheadCursor = mCursor + 1;
+	}
+
+	// Keep the warmed-but-not-imported bytes under budget, always allow one file ahead
+	while (mReadAheadCursor < mFiles.Num())
+	{
+		const uint64 size = mFileSizes[mReadAheadCursor];
+		if (mReadAheadInFlight > 0 && mReadAheadInFlight + size > mSettings.ReadAheadBytes)
+		{
+			break;
+		}
+
+		mReadAheadInFlight += size;
+		mWarmed[mReadAheadCursor] = true;
+		const FString fileName = mFiles[mReadAheadCursor++];
+		mReadAheadTasks.Add(Async(EAsyncExecution::ThreadPool, [this, fileName]() {
+			warmFile(fileName, bCancelled);
+		}));
+	}
+}
+
+void AbcImportQueue::importNext()
+{
+	const int32 index = mCursor++;
+	Utilities::ImportSingleAbc(mFiles[index], mSettings.DestPath);
+
+	if (mWarmed[index])
+	{
+		mReadAheadInFlight -= FMath::Min<uint64>(mReadAheadInFlight, mFileSizes[index]);
+	}
+	++mNumImported;
+	++mSinceFlush;
+}
+
+void AbcImportQueue::onAssetPostImport(UFactory* InFactory, UObject* InCreatedObject)
+{
+	if (InCreatedObject)
+	{
+		mPendingPackages.AddUnique(InCreatedObject->GetOutermost());
+	}
+}
+
+void AbcImportQueue::flushImported()
+{
+	mSinceFlush = 0;
+
+	TArray<UPackage*> packages;
+	for (const TWeakObjectPtr<UPackage>& package : mPendingPackages)
+	{
+		if (package.IsValid())
+		{
+			packages.Add(package.Get());
+		}
+	}
+	mPendingPackages.Empty();
+
+	if (packages.Num() > 0)
+	{
+		UEditorLoadingAndSavingUtils::SavePackages(packages, true);
+		// Unloading is what keeps memory flat, the saved meshes are not needed in the editor
+		UPackageTools::UnloadPackages(packages);
+	}
+	else
+	{
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	// Whatever the editor grew by for other reasons is not the queue's to flush again
+	mBaseUsedBytes = FPlatformMemory::GetStats().UsedPhysical;
+}
+
+void AbcImportQueue::updateNotification()
+{
+	TSharedPtr<SNotificationItem> item = mNotification.Pin();
+	if (!item.IsValid() || mCursor >= mFiles.Num()) return;
+
+	item->SetText(FText::Format(LOCTEXT("AbcImportProgress", "Importing Alembic {0}/{1}: {2}"),
+		FText::AsNumber(mCursor + 1), FText::AsNumber(mFiles.Num()), FText::FromString(FPaths::GetCleanFilename(mFiles[mCursor]))));
+}
+
+void AbcImportQueue::finish()
+{
+	flushImported();
+	bFinished = true;
+
+	if (GEditor && mPostImportHandle.IsValid())
+	{
+		GEditor->GetEditorSubsystem<UImportSubsystem>()->OnAssetPostImport.Remove(mPostImportHandle);
+	}
+
+	const double seconds = FPlatformTime::Seconds() - mStartTime;
+	UE_LOG(LogTemp, Log, TEXT("Abc import%s: %d/%d files in %.1fs, peak held memory %.1f MB"),
+		bCancelled ? TEXT(" cancelled") : TEXT(""), mNumImported, mFiles.Num(), seconds, mPeakHeldBytes / (1024.0 * 1024.0));
+
+	TSharedPtr<SNotificationItem> item = mNotification.Pin();
+	if (item.IsValid())
+	{
+		item->SetText(FText::Format(LOCTEXT("AbcImportDone", "Imported {0}/{1} Alembic files"), FText::AsNumber(mNumImported), FText::AsNumber(mFiles.Num())));
+		item->SetCompletionState(bCancelled ? SNotificationItem::CS_Fail : SNotificationItem::CS_Success);
+		item->ExpireAndFadeout();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
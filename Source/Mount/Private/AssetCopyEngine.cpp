@@ -0,0 +1,287 @@
+#include "AssetCopyEngine.h"
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "FileHelpers.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/ArchiveReplaceObjectRef.h"
+#include "UObject/UObjectHash.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+bool AssetCopyEngine::CopyAssets(const TArray<FAssetData>& assets, const FString& destPath, AssetCopyStats* outStats)
+{
+	AssetCopyStats stats;
+	stats.NumRequested = assets.Num();
+	if (assets.Num() == 0 || !FPackageName::IsValidPath(destPath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Copy assets: nothing to copy or invalid destination %s"), *destPath);
+		return false;
+	}
+
+	FScopedSlowTask slowTask(4.f, LOCTEXT("CopyAssets", "Copying assets..."));
+	slowTask.MakeDialog();
+
+	slowTask.EnterProgressFrame(1.f, LOCTEXT("CopyAssetsClosure", "Gathering dependencies"));
+	double startTime = FPlatformTime::Seconds();
+	TArray<PackageCopy> copies;
+	gatherClosure(assets, copies);
+	mapDestinations(destPath, copies);
+	stats.NumPackages = copies.Num();
+	stats.ClosureSeconds = FPlatformTime::Seconds() - startTime;
+
+	slowTask.EnterProgressFrame(1.f, FText::Format(LOCTEXT("CopyAssetsFiles", "Copying {0} packages"), FText::AsNumber(copies.Num())));
+	startTime = FPlatformTime::Seconds();
+	copyFiles(copies);
+
+	TArray<FString> destFiles;
+	for (const PackageCopy& copy : copies)
+	{
+		if (copy.bCopied)
+		{
+			destFiles.Add(copy.DestFile);
+			++stats.NumCopied;
+		}
+		else if (copy.bUpToDate)
+		{
+			++stats.NumUpToDate;
+		}
+	}
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.ScanFilesSynchronous(destFiles, true);
+	stats.CopySeconds = FPlatformTime::Seconds() - startTime;
+
+	slowTask.EnterProgressFrame(2.f, LOCTEXT("CopyAssetsFixup", "Fixing up references"));
+	startTime = FPlatformTime::Seconds();
+	stats.NumFixedUp = fixupReferences(copies);
+	stats.FixupSeconds = FPlatformTime::Seconds() - startTime;
+
+	UE_LOG(LogTemp, Log, TEXT("Copy assets: %d requested, %d packages in closure, %d copied, %d up to date, %d fixed up (closure %.2fs, copy %.2fs, fixup %.2fs)"),
+		stats.NumRequested, stats.NumPackages, stats.NumCopied, stats.NumUpToDate, stats.NumFixedUp,
+		stats.ClosureSeconds, stats.CopySeconds, stats.FixupSeconds);
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	return stats.NumCopied + stats.NumUpToDate == stats.NumPackages;
+}
+
+void AssetCopyEngine::gatherClosure(const TArray<FAssetData>& assets, TArray<PackageCopy>& outCopies)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	const FString projectContentDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+
+	// Every package is resolved once, INDEX_NONE marks packages that stay where they are
+	TMap<FName, int32> indexOf;
+	auto visit = [&](FName package, bool bRequested) -> int32 {
+		if (const int32* found = indexOf.Find(package))
+		{
+			return *found;
+		}
+
+		int32 index = INDEX_NONE;
+		const FString name = package.ToString();
+		FString file;
+		if (!name.StartsWith(TEXT("/Script/")) && !name.StartsWith(TEXT("/Engine/"))
+			&& FPackageName::DoesPackageExist(name, nullptr, &file))
+		{
+			file = FPaths::ConvertRelativePathToFull(file);
+			// Dependencies already living in the project don't need a copy
+			if (bRequested || !FPaths::IsUnderDirectory(file, projectContentDir))
+			{
+				index = outCopies.AddDefaulted();
+				outCopies[index].SourcePackage = package;
+				outCopies[index].SourceFile = file;
+			}
+		}
+		indexOf.Add(package, index);
+		return index;
+	};
+
+	for (const FAssetData& asset : assets)
+	{
+		visit(asset.PackageName, true);
+	}
+
+	// outCopies grows while we walk it, which makes this a breadth first traversal
+	TArray<FName> dependencies;
+	for (int32 i = 0; i < outCopies.Num(); ++i)
+	{
+		dependencies.Reset();
+		AssetRegistry.GetDependencies(outCopies[i].SourcePackage, dependencies, EAssetRegistryDependencyType::Packages);
+		for (const FName& dependency : dependencies)
+		{
+			const int32 index = visit(dependency, false);
+			if (index != INDEX_NONE && index != i)
+			{
+				outCopies[i].Dependencies.AddUnique(index);
+			}
+		}
+	}
+}
+
+void AssetCopyEngine::mapDestinations(const FString& destPath, TArray<PackageCopy>& copies)
+{
+	if (copies.Num() == 0) return;
+
+	// Keep the layout below the deepest folder shared by every package of the closure
+	TArray<FString> commonSegments;
+	FPackageName::GetLongPackagePath(copies[0].SourcePackage.ToString()).ParseIntoArray(commonSegments, TEXT("/"));
+	TArray<FString> segments;
+	for (const PackageCopy& copy : copies)
+	{
+		segments.Reset();
+		FPackageName::GetLongPackagePath(copy.SourcePackage.ToString()).ParseIntoArray(segments, TEXT("/"));
+		int32 shared = 0;
+		while (shared < commonSegments.Num() && shared < segments.Num() && commonSegments[shared].Equals(segments[shared], ESearchCase::IgnoreCase))
+		{
+			++shared;
+		}
+		commonSegments.SetNum(shared);
+	}
+	const FString commonRoot = TEXT("/") + FString::Join(commonSegments, TEXT("/"));
+
+	FString destRoot = destPath;
+	destRoot.RemoveFromEnd(TEXT("/"));
+	for (PackageCopy& copy : copies)
+	{
+		FString relative = copy.SourcePackage.ToString();
+		relative.RemoveFromStart(commonRoot, ESearchCase::IgnoreCase);
+		relative.RemoveFromStart(TEXT("/"));
+
+		const FString destPackage = destRoot / relative;
+		copy.DestPackage = FName(*destPackage);
+		copy.DestFile = FPaths::ConvertRelativePathToFull(FPackageName::LongPackageNameToFilename(destPackage, FPaths::GetExtension(copy.SourceFile, true)));
+	}
+}
+
+void AssetCopyEngine::copyFiles(TArray<PackageCopy>& copies)
+{
+	// Never overwrite a package the editor has in memory
+	TBitArray<> loaded(false, copies.Num());
+	for (int32 i = 0; i < copies.Num(); ++i)
+	{
+		if (FindPackage(nullptr, *copies[i].DestPackage.ToString()))
+		{
+			loaded[i] = true;
+		}
+	}
+
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	ParallelFor(copies.Num(), [&](int32 index) {
+		PackageCopy& copy = copies[index];
+		const int64 destSize = platformFile.FileSize(*copy.DestFile);
+		if (destSize >= 0 && destSize == platformFile.FileSize(*copy.SourceFile)
+			&& FMD5Hash::HashFile(*copy.DestFile) == FMD5Hash::HashFile(*copy.SourceFile))
+		{
+			copy.bUpToDate = true;
+			return;
+		}
+
+		if (loaded[index])
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Copy assets: %s is loaded, skipped"), *copy.DestPackage.ToString());
+			return;
+		}
+
+		platformFile.CreateDirectoryTree(*FPaths::GetPath(copy.DestFile));
+		copy.bCopied = cloneFile(copy.SourceFile, copy.DestFile);
+		if (!copy.bCopied)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Copy assets: failed %s -> %s"), *copy.SourceFile, *copy.DestFile);
+		}
+	});
+}
+
+bool AssetCopyEngine::cloneFile(const FString& source, const FString& dest)
+{
+#if PLATFORM_WINDOWS
+	// CopyFileW block-clones on ReFS and Dev Drive volumes, elsewhere it is a plain copy
+	return ::CopyFileW(*source, *dest, FALSE) != 0;
+#else
+	return FPlatformFileManager::Get().GetPlatformFile().CopyFile(*dest, *source);
+#endif
+}
+
+int32 AssetCopyEngine::fixupReferences(const TArray<PackageCopy>& copies)
+{
+	TBitArray<> referenced(false, copies.Num());
+	for (const PackageCopy& copy : copies)
+	{
+		for (int32 dependency : copy.Dependencies)
+		{
+			referenced[dependency] = true;
+		}
+	}
+
+	// Source object -> its copy, for every copied package something else imports
+	TMap<UObject*, UObject*> replacements;
+	TArray<UObject*> objects;
+	for (int32 i = 0; i < copies.Num(); ++i)
+	{
+		const PackageCopy& copy = copies[i];
+		if (!referenced[i] || !(copy.bCopied || copy.bUpToDate)) continue;
+
+		UPackage* source = LoadPackage(nullptr, *copy.SourcePackage.ToString(), LOAD_None);
+		UPackage* dest = LoadPackage(nullptr, *copy.DestPackage.ToString(), LOAD_None);
+		if (!source || !dest) continue;
+
+		const FString sourceName = source->GetName();
+		const FString destName = dest->GetName();
+		objects.Reset();
+		GetObjectsWithOuter(dest, objects, true);
+		for (UObject* destObject : objects)
+		{
+			FString sourcePath = destObject->GetPathName();
+			if (!sourcePath.RemoveFromStart(destName)) continue;
+
+			sourcePath = sourceName + sourcePath;
+			if (UObject* sourceObject = StaticFindObject(UObject::StaticClass(), nullptr, *sourcePath))
+			{
+				replacements.Add(sourceObject, destObject);
+			}
+		}
+	}
+
+	if (replacements.Num() == 0) return 0;
+
+	TArray<UPackage*> fixedPackages;
+	for (const PackageCopy& copy : copies)
+	{
+		if (copy.Dependencies.Num() == 0 || !(copy.bCopied || copy.bUpToDate)) continue;
+
+		UPackage* dest = LoadPackage(nullptr, *copy.DestPackage.ToString(), LOAD_None);
+		if (!dest) continue;
+
+		bool bChanged = false;
+		objects.Reset();
+		GetObjectsWithOuter(dest, objects, true);
+		for (UObject* object : objects)
+		{
+			FArchiveReplaceObjectRef<UObject> replaceAr(object, replacements, false, true, false);
+			bChanged |= replaceAr.GetCount() > 0;
+		}
+
+		if (bChanged)
+		{
+			dest->MarkPackageDirty();
+			fixedPackages.Add(dest);
+		}
+	}
+
+	// Each fixed package is saved exactly once
+	UEditorLoadingAndSavingUtils::SavePackages(fixedPackages, true);
+	return fixedPackages.Num();
+}
+
+#undef LOCTEXT_NAMESPACE
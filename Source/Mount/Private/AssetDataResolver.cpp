@@ -0,0 +1,161 @@
+#include "AssetDataResolver.h"
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+
+AssetDataResolver& AssetDataResolver::Get()
+{
+	static TUniquePtr<AssetDataResolver> Singleton = MakeUnique<AssetDataResolver>();
+	return *Singleton;
+}
+
+void AssetDataResolver::bindRegistry()
+{
+	if (bBoundRegistry) return;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.OnAssetAdded().AddRaw(this, &AssetDataResolver::onAssetChanged);
+	AssetRegistry.OnAssetRemoved().AddRaw(this, &AssetDataResolver::onAssetChanged);
+	AssetRegistry.OnAssetUpdated().AddRaw(this, &AssetDataResolver::onAssetChanged);
+	AssetRegistry.OnAssetRenamed().AddRaw(this, &AssetDataResolver::onAssetRenamed);
+	bBoundRegistry = true;
+}
+
+void AssetDataResolver::Shutdown()
+{
+	if (bBoundRegistry && FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnAssetAdded().RemoveAll(this);
+		AssetRegistry.OnAssetRemoved().RemoveAll(this);
+		AssetRegistry.OnAssetUpdated().RemoveAll(this);
+		AssetRegistry.OnAssetRenamed().RemoveAll(this);
+	}
+	bBoundRegistry = false;
+	mObjects.Empty();
+	mPackages.Empty();
+}
+
+bool AssetDataResolver::makeKey(const FString& path, Key& outKey) const
+{
+	FString name = FPackageName::ExportTextPathToObjectPath(path.TrimStartAndEnd());
+	if (FPackageName::IsValidObjectPath(name))
+	{
+		outKey.bIsPackage = false;
+	}
+	else if (FPackageName::IsValidLongPackageName(name))
+	{
+		outKey.bIsPackage = true;
+	}
+	else if (FPackageName::TryConvertFilenameToLongPackageName(path, name))
+	{
+		outKey.bIsPackage = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	outKey.Name = FName(*name);
+	const int32 first = name.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, 1);
+	const int32 second = first != INDEX_NONE ? name.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, first + 1) : INDEX_NONE;
+	outKey.MountPoint = FName(*(second != INDEX_NONE ? name.Left(second) : FPackageName::GetLongPackagePath(name)));
+	return true;
+}
+
+bool AssetDataResolver::Resolve(const FString& path, FAssetData& outAsset)
+{
+	TArray<FAssetData> assets;
+	Resolve(TArray<FString>{ path }, assets);
+	outAsset = assets[0];
+	return outAsset.IsValid();
+}
+
+void AssetDataResolver::Resolve(const TArray<FString>& paths, TArray<FAssetData>& outAssets)
+{
+	check(IsInGameThread());
+	bindRegistry();
+
+	outAssets.Reset();
+	outAssets.SetNum(paths.Num());
+	TArray<Key> keys;
+	keys.SetNum(paths.Num());
+	TBitArray<> valid(false, paths.Num());
+
+	// Cache misses, grouped by mount point and by kind since one filter can't mix object paths and package names
+	TMap<TPair<FName, bool>, TSet<FName>> groups;
+	for (int32 i = 0; i < paths.Num(); ++i)
+	{
+		if (!makeKey(paths[i], keys[i])) continue;
+		valid[i] = true;
+
+		const FAssetData* cached = (keys[i].bIsPackage ? mPackages : mObjects).Find(keys[i].Name);
+		if (cached)
+		{
+			outAssets[i] = *cached;
+		}
+		else
+		{
+			groups.FindOrAdd(TPair<FName, bool>(keys[i].MountPoint, keys[i].bIsPackage)).Add(keys[i].Name);
+		}
+	}
+	if (groups.Num() == 0) return;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	TArray<FAssetData> found;
+	for (const TPair<TPair<FName, bool>, TSet<FName>>& group : groups)
+	{
+		const bool bIsPackage = group.Key.Value;
+		FARFilter filter;
+		(bIsPackage ? filter.PackageNames : filter.ObjectPaths) = group.Value.Array();
+		found.Reset();
+		AssetRegistry.GetAssets(filter, found);
+		++mNumQueries;
+
+		// Misses are remembered too, the registry announces the asset if it shows up later
+		TMap<FName, FAssetData>& cache = bIsPackage ? mPackages : mObjects;
+		for (FName name : group.Value)
+		{
+			cache.Add(name, FAssetData());
+		}
+		for (const FAssetData& asset : found)
+		{
+			if (!bIsPackage)
+			{
+				cache.Add(asset.ObjectPath, asset);
+				continue;
+			}
+
+			// A package resolves to its primary asset, the one named after the package
+			FAssetData& entry = cache.FindOrAdd(asset.PackageName);
+			if (!entry.IsValid() || asset.AssetName == FPackageName::GetShortFName(asset.PackageName))
+			{
+				entry = asset;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < paths.Num(); ++i)
+	{
+		if (valid[i] && !outAssets[i].IsValid())
+		{
+			outAssets[i] = (keys[i].bIsPackage ? mPackages : mObjects).FindRef(keys[i].Name);
+		}
+	}
+}
+
+void AssetDataResolver::invalidate(FName objectPath, FName packageName)
+{
+	mObjects.Remove(objectPath);
+	mPackages.Remove(packageName);
+}
+
+void AssetDataResolver::onAssetChanged(const FAssetData& asset)
+{
+	invalidate(asset.ObjectPath, asset.PackageName);
+}
+
+void AssetDataResolver::onAssetRenamed(const FAssetData& asset, const FString& oldObjectPath)
+{
+	invalidate(asset.ObjectPath, asset.PackageName);
+	invalidate(FName(*oldObjectPath), FName(*FPackageName::ObjectPathToPackageName(oldObjectPath)));
+}
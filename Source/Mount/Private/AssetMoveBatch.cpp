@@ -0,0 +1,213 @@
+#include "AssetMoveBatch.h"
+#include "AssetRegistryModule.h"
+#include "AssetToolsModule.h"
+#include "FileHelpers.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+#include "UObject/MetaData.h"
+#include "UObject/ObjectRedirector.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+bool AssetMoveBatch::MoveAssets(const TArray<UObject*>& assets, const FString& destPath, const TMap<UObject*, FString>& newNameMap, const FString& sourcePath, AssetMoveStats* outStats)
+{
+	AssetMoveStats stats;
+	FScopedSlowTask slowTask(4.f, FText::Format(LOCTEXT("MoveAssets", "Moving {0} assets"), FText::AsNumber(assets.Num())));
+	slowTask.MakeDialog();
+
+	// Validate
+	slowTask.EnterProgressFrame(1.f);
+	double startTime = FPlatformTime::Seconds();
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	TArray<FAssetRenameData> renames;
+	TArray<FString> oldObjectPaths;
+	TArray<FString> newObjectPaths;
+	TSet<FString> destObjectPaths;
+	// Packages whose contents change: the moved assets and everything referencing them
+	TSet<FName> affectedPackages;
+	TArray<FName> referencers;
+	renames.Reserve(assets.Num());
+	// Matched per path segment, "/Game/Lib" is not a prefix of "/Game/Library"
+	FString sourceDir = sourcePath;
+	sourceDir.RemoveFromEnd(TEXT("/"));
+	const FString sourcePrefix = sourceDir + TEXT("/");
+	for (UObject* asset : assets)
+	{
+		if (!asset) continue;
+
+		// Keep the folder structure below sourcePath
+		FString newPath = destPath;
+		const FString oldPath = FPackageName::GetLongPackagePath(asset->GetOutermost()->GetName());
+		if (!sourceDir.IsEmpty() && oldPath.StartsWith(sourcePrefix))
+		{
+			newPath = destPath / oldPath.RightChop(sourcePrefix.Len());
+			newPath.RemoveFromEnd(TEXT("/"));
+		}
+
+		const FString* mappedName = newNameMap.Find(asset);
+		const FString newName = mappedName ? *mappedName : asset->GetName();
+		const FString newObjectPath = newPath / newName + TEXT(".") + newName;
+
+		bool bAlreadyInSet = false;
+		destObjectPaths.Add(newObjectPath, &bAlreadyInSet);
+		if (bAlreadyInSet || AssetRegistry.GetAssetByObjectPath(FName(*newObjectPath)).IsValid() || FindObject<UObject>(nullptr, *newObjectPath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Move assets: %s already exists, nothing was moved"), *newObjectPath);
+			return false;
+		}
+
+		referencers.Reset();
+		AssetRegistry.GetReferencers(asset->GetOutermost()->GetFName(), referencers);
+		affectedPackages.Append(referencers);
+		affectedPackages.Add(FName(*(newPath / newName)));
+
+		oldObjectPaths.Add(asset->GetPathName());
+		newObjectPaths.Add(newObjectPath);
+		renames.Emplace(asset, newPath, newName);
+	}
+	stats.NumAssets = renames.Num();
+	stats.ValidateSeconds = FPlatformTime::Seconds() - startTime;
+	if (renames.Num() == 0) return false;
+
+	// The asset tools save referencing packages on their own, count those saves too
+	int32 numSaved = 0;
+	const FDelegateHandle savedHandle = UPackage::PackageSavedEvent.AddLambda([&numSaved](const FString&, UObject*) {
+		++numSaved;
+	});
+
+	// Rename, the asset tools group referencers per package internally
+	slowTask.EnterProgressFrame(1.f);
+	startTime = FPlatformTime::Seconds();
+	IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools")).Get();
+	const bool bRenamed = AssetTools.RenameAssets(renames);
+	stats.RenameSeconds = FPlatformTime::Seconds() - startTime;
+
+	// Indices of the renames that went through
+	TArray<int32> moved;
+	for (int32 i = 0; i < renames.Num(); ++i)
+	{
+		UObject* asset = renames[i].Asset.Get();
+		if (asset && asset->GetPathName() == newObjectPaths[i])
+		{
+			moved.Add(i);
+		}
+	}
+	stats.NumMoved = moved.Num();
+
+	if (!bRenamed || moved.Num() != renames.Num())
+	{
+		// Fixing up and saving would make a half done move permanent, leave it for the user to look at
+		UPackage::PackageSavedEvent.Remove(savedHandle);
+		stats.NumPackagesSaved = numSaved;
+		UE_LOG(LogTemp, Error, TEXT("Move assets: renaming failed, %d/%d assets moved, nothing fixed up or saved"), moved.Num(), renames.Num());
+		for (int32 index : moved)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Move assets: moved %s to %s"), *oldObjectPaths[index], *newObjectPaths[index]);
+		}
+
+		FNotificationInfo info(FText::Format(LOCTEXT("MoveAssetsFailed", "Moving assets failed, {0} of {1} moved. See the log for which."),
+			FText::AsNumber(moved.Num()), FText::AsNumber(renames.Num())));
+		info.ExpireDuration = 8.f;
+		TSharedPtr<SNotificationItem> item = FSlateNotificationManager::Get().AddNotification(info);
+		if (item.IsValid())
+		{
+			item->SetCompletionState(SNotificationItem::CS_Fail);
+		}
+
+		if (outStats)
+		{
+			*outStats = stats;
+		}
+		return false;
+	}
+
+	// Fix up every redirector left behind in one pass
+	slowTask.EnterProgressFrame(1.f);
+	startTime = FPlatformTime::Seconds();
+	TArray<UObjectRedirector*> redirectors;
+	for (const FString& oldObjectPath : oldObjectPaths)
+	{
+		if (UObjectRedirector* redirector = FindObject<UObjectRedirector>(nullptr, *oldObjectPath))
+		{
+			redirectors.Add(redirector);
+		}
+	}
+	if (redirectors.Num() > 0)
+	{
+		AssetTools.FixupReferencers(redirectors);
+	}
+	stats.NumRedirectorsFixed = redirectors.Num();
+	stats.FixupSeconds = FPlatformTime::Seconds() - startTime;
+
+	// Save what the rename and fixup left dirty
+	slowTask.EnterProgressFrame(1.f);
+	startTime = FPlatformTime::Seconds();
+	TArray<UPackage*> dirtyPackages;
+	for (const FName& packageName : affectedPackages)
+	{
+		UPackage* package = FindPackage(nullptr, *packageName.ToString());
+		if (package && package->IsDirty())
+		{
+			dirtyPackages.Add(package);
+		}
+	}
+	if (dirtyPackages.Num() > 0)
+	{
+		UEditorLoadingAndSavingUtils::SavePackages(dirtyPackages, true);
+	}
+	UPackage::PackageSavedEvent.Remove(savedHandle);
+	stats.NumPackagesSaved = numSaved;
+	stats.SaveSeconds = FPlatformTime::Seconds() - startTime;
+
+	UE_LOG(LogTemp, Log, TEXT("Move assets: %d assets, %d redirectors, %d packages saved (validate %.2fs, rename %.2fs, fixup %.2fs, save %.2fs)"),
+		stats.NumAssets, stats.NumRedirectorsFixed, stats.NumPackagesSaved,
+		stats.ValidateSeconds, stats.RenameSeconds, stats.FixupSeconds, stats.SaveSeconds);
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	return true;
+}
+
+void AssetMoveBatch::CopyMetaData(const TMap<FName, FString>& sourceAndDestPackages)
+{
+	TArray<UPackage*> changedPackages;
+	for (const TPair<FName, FString>& pair : sourceAndDestPackages)
+	{
+		UPackage* source = FindPackage(nullptr, *pair.Key.ToString());
+		UPackage* dest = FindPackage(nullptr, *pair.Value);
+		if (!source || !dest || !source->HasMetaData()) continue;
+
+		UMetaData* sourceMeta = source->GetMetaData();
+		UMetaData* destMeta = dest->GetMetaData();
+		const FString sourceName = source->GetName();
+		const FString destName = dest->GetName();
+
+		// Objects keep their names in the copy, only the package part of the path changes
+		for (const auto& entry : sourceMeta->ObjectMetaDataMap)
+		{
+			UObject* sourceObject = entry.Key.Get();
+			if (!sourceObject) continue;
+
+			FString destObjectPath = sourceObject->GetPathName();
+			if (!destObjectPath.RemoveFromStart(sourceName)) continue;
+
+			if (UObject* destObject = StaticFindObject(UObject::StaticClass(), nullptr, *(destName + destObjectPath)))
+			{
+				destMeta->SetObjectValues(destObject, entry.Value);
+			}
+		}
+		destMeta->RootMetaDataMap.Append(sourceMeta->RootMetaDataMap);
+		changedPackages.Add(dest);
+	}
+
+	for (UPackage* package : changedPackages)
+	{
+		package->MarkPackageDirty();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
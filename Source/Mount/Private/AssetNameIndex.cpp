@@ -0,0 +1,164 @@
+#include "AssetNameIndex.h"
+#include "AssetRegistryModule.h"
+#include "DirectoryWalker.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
+#include "ObjectTools.h"
+
+AssetNameIndex& AssetNameIndex::Get()
+{
+	// Function statics are initialized once even when importers race for the first call
+	static TUniquePtr<AssetNameIndex> Singleton = MakeUnique<AssetNameIndex>();
+	return *Singleton;
+}
+
+AssetNameIndex::AssetNameIndex()
+{
+	if (IsInGameThread())
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnAssetAdded().AddRaw(this, &AssetNameIndex::onAssetAdded);
+		AssetRegistry.OnAssetRemoved().AddRaw(this, &AssetNameIndex::onAssetRemoved);
+		AssetRegistry.OnAssetRenamed().AddRaw(this, &AssetNameIndex::onAssetRenamed);
+		bBoundRegistry = true;
+	}
+}
+
+void AssetNameIndex::Shutdown()
+{
+	if (bBoundRegistry && FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnAssetAdded().RemoveAll(this);
+		AssetRegistry.OnAssetRemoved().RemoveAll(this);
+		AssetRegistry.OnAssetRenamed().RemoveAll(this);
+	}
+	bBoundRegistry = false;
+
+	FScopeLock lock(&mLock);
+	mDirectories.Empty();
+}
+
+void AssetNameIndex::CreateUniqueAssetName(const FString& basePackageName, const FString& suffix, FString& outPackageName, FString& outAssetName)
+{
+	const FString packagePath = FPackageName::GetLongPackagePath(basePackageName);
+	const FString baseName = ObjectTools::SanitizeObjectName(FPackageName::GetLongPackageAssetName(basePackageName));
+
+	// "Rock_07" continues with "Rock_08", keeping the zero padding
+	int32 charIndex = baseName.Len() - 1;
+	while (charIndex >= 0 && FChar::IsDigit(baseName[charIndex]))
+	{
+		--charIndex;
+	}
+	const FString prefix = baseName.Left(charIndex + 1);
+	const FString trailing = baseName.RightChop(charIndex + 1);
+
+	FScopeLock lock(&mLock);
+	DirectoryIndex& index = findOrBuild(packagePath);
+	auto isTaken = [&](const FString& name) {
+		return index.Taken.Contains(name.ToLower()) || (IsInGameThread() && FindPackage(nullptr, *(packagePath / name)));
+	};
+
+	FString assetName = baseName + suffix;
+	if (isTaken(assetName))
+	{
+		const FString key = (prefix + TEXT("|") + suffix).ToLower();
+		int32* next = index.NextSuffix.Find(key);
+		if (!next)
+		{
+			next = &index.NextSuffix.Add(key, trailing.IsEmpty() ? 1 : FCString::Atoi(*trailing) + 1);
+		}
+
+		do
+		{
+			FString number = FString::FromInt((*next)++);
+			if (number.Len() < trailing.Len())
+			{
+				number = FString::ChrN(trailing.Len() - number.Len(), TEXT('0')) + number;
+			}
+			assetName = prefix + number + suffix;
+		} while (isTaken(assetName));
+	}
+
+	index.Taken.Add(assetName.ToLower());
+	outAssetName = assetName;
+	outPackageName = packagePath / assetName;
+}
+
+AssetNameIndex::DirectoryIndex& AssetNameIndex::findOrBuild(const FString& packagePath)
+{
+	const FString key = packagePath.ToLower();
+	if (TUniquePtr<DirectoryIndex>* found = mDirectories.Find(key))
+	{
+		return **found;
+	}
+
+	DirectoryIndex& index = *mDirectories.Add(key, MakeUnique<DirectoryIndex>());
+	// The registry may not have finished scanning a fresh mount, the disk listing covers that
+	buildFromDisk(packagePath, index);
+	if (IsInGameThread())
+	{
+		buildFromRegistry(packagePath, index);
+	}
+	return index;
+}
+
+void AssetNameIndex::buildFromRegistry(const FString& packagePath, DirectoryIndex& index)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	TArray<FAssetData> assets;
+	AssetRegistry.GetAssetsByPath(FName(*packagePath), assets, false, false);
+	for (const FAssetData& asset : assets)
+	{
+		index.Taken.Add(asset.AssetName.ToString().ToLower());
+	}
+}
+
+void AssetNameIndex::buildFromDisk(const FString& packagePath, DirectoryIndex& index)
+{
+	FString dir;
+	if (!FPackageName::TryConvertLongPackageNameToFilename(packagePath + TEXT("/"), dir)) return;
+
+	const FString assetExtension = FPackageName::GetAssetPackageExtension();
+	const FString mapExtension = FPackageName::GetMapPackageExtension();
+	TArray<DirectoryEntry> entries;
+	DirectoryWalker().List(dir, entries);
+	for (const DirectoryEntry& entry : entries)
+	{
+		if (!entry.bIsDirectory && (entry.Path.EndsWith(assetExtension) || entry.Path.EndsWith(mapExtension)))
+		{
+			index.Taken.Add(FPaths::GetBaseFilename(entry.Path).ToLower());
+		}
+	}
+}
+
+void AssetNameIndex::onAssetAdded(const FAssetData& asset)
+{
+	FScopeLock lock(&mLock);
+	if (TUniquePtr<DirectoryIndex>* found = mDirectories.Find(asset.PackagePath.ToString().ToLower()))
+	{
+		(*found)->Taken.Add(asset.AssetName.ToString().ToLower());
+	}
+}
+
+void AssetNameIndex::onAssetRemoved(const FAssetData& asset)
+{
+	FScopeLock lock(&mLock);
+	if (TUniquePtr<DirectoryIndex>* found = mDirectories.Find(asset.PackagePath.ToString().ToLower()))
+	{
+		(*found)->Taken.Remove(asset.AssetName.ToString().ToLower());
+	}
+}
+
+void AssetNameIndex::onAssetRenamed(const FAssetData& asset, const FString& oldObjectPath)
+{
+	const FString oldPackageName = FPackageName::ObjectPathToPackageName(oldObjectPath);
+	{
+		FScopeLock lock(&mLock);
+		if (TUniquePtr<DirectoryIndex>* found = mDirectories.Find(FPackageName::GetLongPackagePath(oldPackageName).ToLower()))
+		{
+			(*found)->Taken.Remove(FPackageName::GetLongPackageAssetName(oldPackageName).ToLower());
+		}
+	}
+	onAssetAdded(asset);
+}
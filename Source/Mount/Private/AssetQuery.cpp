@@ -0,0 +1,132 @@
+#include "AssetQuery.h"
+#include "AssetRegistryModule.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+	FARFilter makeFilter(const TArray<FName>& paths, const AssetQueryOptions& options)
+	{
+		FARFilter filter;
+		filter.PackagePaths = paths;
+		filter.bRecursivePaths = options.bRecursive;
+		filter.ClassNames = options.ClassNames;
+		filter.bIncludeOnlyOnDiskAssets = options.bOnlyOnDisk;
+		return filter;
+	}
+
+	IAssetRegistry& getAssetRegistry()
+	{
+		return FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	}
+}
+
+int32 AssetQuery::ForEachPage(const TArray<FName>& paths, const AssetQueryOptions& options, FOnPage onPage)
+{
+	if (paths.Num() == 0) return 0;
+
+	const int32 pageSize = FMath::Max(1, options.PageSize);
+	TArray<FAssetData> page;
+	page.Reserve(pageSize);
+	int32 delivered = 0;
+	bool bStopped = false;
+
+	// The page buffer is reused, memory stays at one page whatever the size of the library
+	getAssetRegistry().EnumerateAssets(makeFilter(paths, options), [&](const FAssetData& asset) {
+		if (options.Filter && !options.Filter(asset)) return true;
+
+		page.Add(asset);
+		if (page.Num() >= pageSize)
+		{
+			delivered += page.Num();
+			bStopped = !onPage(page);
+			page.Reset();
+		}
+		return !bStopped;
+	});
+
+	if (!bStopped && page.Num() > 0)
+	{
+		delivered += page.Num();
+		onPage(page);
+	}
+	return delivered;
+}
+
+int32 AssetQuery::ForEachAsset(const TArray<FName>& paths, const AssetQueryOptions& options, TFunctionRef<bool(const FAssetData&)> onAsset)
+{
+	return ForEachPage(paths, options, [&](TArrayView<const FAssetData> page) {
+		for (const FAssetData& asset : page)
+		{
+			if (!onAsset(asset)) return false;
+		}
+		return true;
+	});
+}
+
+int32 AssetQuery::ForEachPageParallel(const TArray<FName>& roots, const AssetQueryOptions& options, const FOnParallelPage& onPage)
+{
+	check(IsInGameThread());
+	if (roots.Num() == 0) return 0;
+
+	const int32 pageSize = FMath::Max(1, options.PageSize);
+	// Bound the number of pages alive at once so memory stays flat
+	const int32 maxInFlight = FMath::Max(2, FTaskGraphInterface::Get().GetNumWorkerThreads() * 2);
+	TAtomic<bool> bStop{ false };
+	TAtomic<int32> delivered{ 0 };
+	FThreadSafeCounter inFlight;
+	FGraphEventArray tasks;
+
+	IAssetRegistry& AssetRegistry = getAssetRegistry();
+	for (int32 rootIndex = 0; rootIndex < roots.Num() && !bStop; ++rootIndex)
+	{
+		TArray<FAssetData> page;
+		page.Reserve(pageSize);
+
+		auto dispatch = [&]() {
+			while (inFlight.GetValue() >= maxInFlight)
+			{
+				FPlatformProcess::SleepNoStats(0.0001f);
+			}
+			inFlight.Increment();
+			tasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([page = MoveTemp(page), rootIndex, &options, &onPage, &bStop, &delivered, &inFlight]() mutable {
+				if (!bStop)
+				{
+					if (options.Filter)
+					{
+						page.RemoveAll([&options](const FAssetData& asset) { return !options.Filter(asset); });
+					}
+					if (page.Num() > 0)
+					{
+						delivered += page.Num();
+						if (!onPage(rootIndex, page))
+						{
+							bStop = true;
+						}
+					}
+				}
+				inFlight.Decrement();
+			}, TStatId(), nullptr, ENamedThreads::AnyThread));
+
+			page = TArray<FAssetData>();
+			page.Reserve(pageSize);
+		};
+
+		TArray<FName> rootPaths{ roots[rootIndex] };
+		AssetRegistry.EnumerateAssets(makeFilter(rootPaths, options), [&](const FAssetData& asset) {
+			page.Add(asset);
+			if (page.Num() >= pageSize)
+			{
+				dispatch();
+			}
+			return !bStop;
+		});
+
+		if (!bStop && page.Num() > 0)
+		{
+			dispatch();
+		}
+	}
+
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(tasks, ENamedThreads::GameThread_Local);
+	return delivered;
+}
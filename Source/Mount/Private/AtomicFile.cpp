@@ -0,0 +1,46 @@
+#include "AtomicFile.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <stdio.h>
+#endif
+
+bool AtomicFile::Replace(const FString& target, const FString& source)
+{
+	const FString fullTarget = FPaths::ConvertRelativePathToFull(target);
+	const FString fullSource = FPaths::ConvertRelativePathToFull(source);
+#if PLATFORM_WINDOWS
+	// Same volume, so this is a rename. Fails instead of deleting first when target is open without share delete.
+	return ::MoveFileExW(*fullSource, *fullTarget, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return ::rename(TCHAR_TO_UTF8(*fullSource), TCHAR_TO_UTF8(*fullTarget)) == 0;
+#endif
+}
+
+bool AtomicFile::SaveArrayToFile(TArrayView<const uint8> bytes, const FString& file)
+{
+	const FString tempFile = makeTempPath(file);
+	if (FFileHelper::SaveArrayToFile(bytes, *tempFile) && Replace(file, tempFile)) return true;
+
+	IFileManager::Get().Delete(*tempFile, false, false, true);
+	return false;
+}
+
+bool AtomicFile::SaveStringToFile(const FString& text, const FString& file, FFileHelper::EEncodingOptions encoding)
+{
+	const FString tempFile = makeTempPath(file);
+	if (FFileHelper::SaveStringToFile(text, *tempFile, encoding) && Replace(file, tempFile)) return true;
+
+	IFileManager::Get().Delete(*tempFile, false, false, true);
+	return false;
+}
+
+FString AtomicFile::makeTempPath(const FString& file)
+{
+	return file + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+}
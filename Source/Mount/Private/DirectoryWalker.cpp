@@ -0,0 +1,77 @@
+#include "DirectoryWalker.h"
+#include "HAL/PlatformFilemanager.h"
+
+namespace
+{
+	TAtomic<uint64> GTotalCalls(0);
+
+	DirectoryEntry makeEntry(const TCHAR* path, const FFileStatData& stat)
+	{
+		DirectoryEntry entry;
+		entry.Path = path;
+		entry.bIsDirectory = stat.bIsDirectory;
+		entry.Size = stat.FileSize;
+		entry.ModificationTime = stat.ModificationTime;
+		return entry;
+	}
+}
+
+uint64 DirectoryWalker::GetTotalCalls()
+{
+	return GTotalCalls.Load();
+}
+
+void DirectoryWalker::countCall()
+{
+	++mNumCalls;
+	++GTotalCalls;
+}
+
+bool DirectoryWalker::List(const FString& dir, TArray<DirectoryEntry>& outEntries)
+{
+	countCall();
+	return FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*dir, [&outEntries](const TCHAR* path, const FFileStatData& stat) {
+		outEntries.Add(makeEntry(path, stat));
+		return true;
+	});
+}
+
+bool DirectoryWalker::ListRecursive(const FString& dir, TArray<DirectoryEntry>& outEntries)
+{
+	// Iterative so deep trees don't grow the stack, entries of a directory are appended before its children
+	TArray<FString> pending;
+	pending.Add(dir);
+	bool bResult = true;
+	while (pending.Num() > 0)
+	{
+		const FString current = pending.Pop(false);
+		const int32 first = outEntries.Num();
+		bResult &= List(current, outEntries);
+		for (int32 i = first; i < outEntries.Num(); ++i)
+		{
+			if (outEntries[i].bIsDirectory)
+			{
+				pending.Add(outEntries[i].Path);
+			}
+		}
+	}
+	return bResult;
+}
+
+bool DirectoryWalker::Stat(const FString& path, DirectoryEntry& outEntry)
+{
+	countCall();
+	const FFileStatData stat = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*path);
+	if (!stat.bIsValid)
+	{
+		return false;
+	}
+	outEntry = makeEntry(*path, stat);
+	return true;
+}
+
+bool DirectoryWalker::DirectoryExists(const FString& path)
+{
+	DirectoryEntry entry;
+	return Stat(path, entry) && entry.bIsDirectory;
+}
@@ -0,0 +1,379 @@
+#include "LibraryUploader.h"
+#include "Async/ParallelFor.h"
+#include "AtomicFile.h"
+#include "DirectoryWalker.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+namespace
+{
+	const int32 ManifestVersion = 1;
+	const int64 ReadBufferBytes = 1024 * 1024;
+
+	// Gear hash table for chunking. Generated from a fixed seed so boundaries are the same on every machine and run.
+	struct GearTable
+	{
+		uint64 Values[256];
+
+		GearTable()
+		{
+			uint64 state = 0x9E3779B97F4A7C15ull;
+			for (uint64& value : Values)
+			{
+				// splitmix64
+				state += 0x9E3779B97F4A7C15ull;
+				uint64 z = state;
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+				value = z ^ (z >> 31);
+			}
+		}
+	};
+
+	const GearTable& getGearTable()
+	{
+		static GearTable table;
+		return table;
+	}
+
+	struct ChunkRef
+	{
+		FString Id;
+		int64 Size = 0;
+	};
+
+	struct FileEntry
+	{
+		// Relative to the library root
+		FString Path;
+		int64 Size = 0;
+		int64 ModifiedTicks = 0;
+		FString Hash;
+		TArray<ChunkRef> Chunks;
+	};
+
+	FString hashToString(FSHA1& hasher)
+	{
+		hasher.Final();
+		FSHAHash hash;
+		hasher.GetHash(hash.Hash);
+		return hash.ToString();
+	}
+
+	bool loadManifest(const FString& manifestPath, TMap<FString, FileEntry>& outFiles)
+	{
+		FString json;
+		if (!FFileHelper::LoadFileToString(json, *manifestPath)) return false;
+
+		TSharedPtr<FJsonObject> root;
+		TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+		if (!FJsonSerializer::Deserialize(reader, root) || !root.IsValid()) return false;
+
+		const TArray<TSharedPtr<FJsonValue>>* files = nullptr;
+		if (!root->TryGetArrayField(TEXT("Files"), files)) return false;
+		for (const TSharedPtr<FJsonValue>& value : *files)
+		{
+			const TSharedPtr<FJsonObject>* object = nullptr;
+			if (!value->TryGetObject(object)) continue;
+
+			FileEntry entry;
+			FString size, modified;
+			(*object)->TryGetStringField(TEXT("Path"), entry.Path);
+			(*object)->TryGetStringField(TEXT("Size"), size);
+			(*object)->TryGetStringField(TEXT("Modified"), modified);
+			(*object)->TryGetStringField(TEXT("Hash"), entry.Hash);
+			LexFromString(entry.Size, *size);
+			LexFromString(entry.ModifiedTicks, *modified);
+
+			const TArray<TSharedPtr<FJsonValue>>* chunks = nullptr;
+			if ((*object)->TryGetArrayField(TEXT("Chunks"), chunks))
+			{
+				for (const TSharedPtr<FJsonValue>& chunkValue : *chunks)
+				{
+					// "id:size"
+					FString id, chunkSize;
+					if (chunkValue->AsString().Split(TEXT(":"), &id, &chunkSize))
+					{
+						ChunkRef& chunk = entry.Chunks.AddDefaulted_GetRef();
+						chunk.Id = id;
+						LexFromString(chunk.Size, *chunkSize);
+					}
+				}
+			}
+			outFiles.Add(entry.Path, MoveTemp(entry));
+		}
+		return true;
+	}
+
+	bool saveManifest(const FString& manifestPath, const FString& libraryName, const TArray<FileEntry>& files)
+	{
+		TArray<TSharedPtr<FJsonValue>> fileValues;
+		fileValues.Reserve(files.Num());
+		for (const FileEntry& entry : files)
+		{
+			TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+			object->SetStringField(TEXT("Path"), entry.Path);
+			// 64 bit values as strings, JSON numbers are doubles
+			object->SetStringField(TEXT("Size"), LexToString(entry.Size));
+			object->SetStringField(TEXT("Modified"), LexToString(entry.ModifiedTicks));
+			object->SetStringField(TEXT("Hash"), entry.Hash);
+			TArray<TSharedPtr<FJsonValue>> chunks;
+			chunks.Reserve(entry.Chunks.Num());
+			for (const ChunkRef& chunk : entry.Chunks)
+			{
+				chunks.Add(MakeShared<FJsonValueString>(chunk.Id + TEXT(":") + LexToString(chunk.Size)));
+			}
+			object->SetArrayField(TEXT("Chunks"), chunks);
+			fileValues.Add(MakeShared<FJsonValueObject>(object));
+		}
+
+		TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+		root->SetNumberField(TEXT("Version"), ManifestVersion);
+		root->SetStringField(TEXT("Library"), libraryName);
+		root->SetStringField(TEXT("Published"), FDateTime::UtcNow().ToIso8601());
+		root->SetArrayField(TEXT("Files"), fileValues);
+
+		FString json;
+		TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+		FJsonSerializer::Serialize(root, writer);
+
+		// Readers either see the old manifest or the new one, all chunks of both exist
+		return AtomicFile::SaveStringToFile(json, manifestPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	}
+
+	// Chunks known to be in the store, shared by the hashing workers
+	class ChunkStore
+	{
+	public:
+		ChunkStore(const FString& storeDir, LibraryUploadStats& stats)
+			: mStoreDir(storeDir), mStats(stats)
+		{
+		}
+
+		void AddKnown(const FString& id)
+		{
+			mKnown.Add(id);
+		}
+
+		bool Put(const FString& id, const uint8* data, int64 size)
+		{
+			{
+				FScopeLock lock(&mLock);
+				if (mKnown.Contains(id)) return true;
+				// Claimed before writing so two files sharing a chunk write it once
+				mKnown.Add(id);
+			}
+
+			const FString chunkPath = LibraryUploader::GetChunkPath(mStoreDir, id);
+			IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+			if (platformFile.FileSize(*chunkPath) == size) return true;
+
+			platformFile.CreateDirectoryTree(*FPaths::GetPath(chunkPath));
+			const FString tempPath = chunkPath + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+			bool bWritten = false;
+			{
+				TUniquePtr<IFileHandle> handle(platformFile.OpenWrite(*tempPath));
+				bWritten = handle && handle->Write(data, size);
+			}
+			if (!bWritten || !platformFile.MoveFile(*chunkPath, *tempPath))
+			{
+				platformFile.DeleteFile(*tempPath);
+				// Another publisher may have moved the same chunk in first
+				if (platformFile.FileSize(*chunkPath) == size) return true;
+
+				FScopeLock lock(&mLock);
+				mKnown.Remove(id);
+				return false;
+			}
+
+			FScopeLock lock(&mLock);
+			++mStats.NumNewChunks;
+			mStats.NewBytes += size;
+			return true;
+		}
+
+	private:
+		FString mStoreDir;
+		LibraryUploadStats& mStats;
+		FCriticalSection mLock;
+		TSet<FString> mKnown;
+	};
+
+	bool chunkFile(const FString& file, const LibraryUploadSettings& settings, ChunkStore& store, FileEntry& entry)
+	{
+		TUniquePtr<IFileHandle> handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*file));
+		if (!handle) return false;
+
+		const GearTable& gear = getGearTable();
+		const uint64 mask = (1ull << settings.AverageChunkBits) - 1;
+		TArray<uint8> buffer;
+		buffer.SetNumUninitialized(ReadBufferBytes);
+		TArray<uint8> chunk;
+		chunk.Reserve(settings.MaxChunkBytes);
+		FSHA1 fileHasher;
+		uint64 rolling = 0;
+		bool bOk = true;
+
+		auto emitChunk = [&]() {
+			FSHA1 chunkHasher;
+			chunkHasher.Update(chunk.GetData(), chunk.Num());
+			ChunkRef& ref = entry.Chunks.AddDefaulted_GetRef();
+			ref.Id = hashToString(chunkHasher);
+			ref.Size = chunk.Num();
+			bOk &= store.Put(ref.Id, chunk.GetData(), chunk.Num());
+			chunk.Reset();
+			rolling = 0;
+		};
+
+		int64 remaining = handle->Size();
+		while (remaining > 0 && bOk)
+		{
+			const int64 read = FMath::Min(remaining, ReadBufferBytes);
+			if (!handle->Read(buffer.GetData(), read)) return false;
+			remaining -= read;
+			fileHasher.Update(buffer.GetData(), read);
+
+			for (int64 i = 0; i < read; ++i)
+			{
+				const uint8 byte = buffer[i];
+				chunk.Add(byte);
+				rolling = (rolling << 1) + gear.Values[byte];
+				if ((chunk.Num() >= settings.MinChunkBytes && (rolling & mask) == 0) || chunk.Num() >= settings.MaxChunkBytes)
+				{
+					emitChunk();
+				}
+			}
+		}
+		if (chunk.Num() > 0)
+		{
+			emitChunk();
+		}
+		entry.Hash = hashToString(fileHasher);
+		return bOk;
+	}
+}
+
+FString LibraryUploader::GetManifestPath(const LibraryUploadSettings& settings)
+{
+	return settings.StoreDir / TEXT("libraries") / settings.LibraryName + TEXT(".json");
+}
+
+FString LibraryUploader::GetChunkPath(const FString& storeDir, const FString& chunkId)
+{
+	return storeDir / TEXT("chunks") / chunkId.Left(2) / chunkId;
+}
+
+bool LibraryUploader::Upload(const FString& sourceDir, const LibraryUploadSettings& settings, LibraryUploadStats* outStats)
+{
+	LibraryUploadStats stats;
+	const double startTime = FPlatformTime::Seconds();
+	if (settings.StoreDir.IsEmpty() || settings.LibraryName.IsEmpty() || !FPaths::DirectoryExists(sourceDir))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Library upload: invalid source %s or store %s"), *sourceDir, *settings.StoreDir);
+		return false;
+	}
+
+	FScopedSlowTask slowTask(3.f, FText::Format(LOCTEXT("LibraryUpload", "Publishing library {0}..."), FText::FromString(settings.LibraryName)));
+	slowTask.MakeDialog();
+
+	// List once, size and mtime come with the listing
+	slowTask.EnterProgressFrame(1.f);
+	FString root = sourceDir;
+	FPaths::NormalizeDirectoryName(root);
+	TArray<DirectoryEntry> listing;
+	DirectoryWalker().ListRecursive(root, listing);
+	listing.RemoveAll([](const DirectoryEntry& entry) { return entry.bIsDirectory; });
+
+	// Chunks the previous manifest references are in the store already
+	TMap<FString, FileEntry> previous;
+	const FString manifestPath = GetManifestPath(settings);
+	loadManifest(manifestPath, previous);
+	ChunkStore store(settings.StoreDir, stats);
+	for (const TPair<FString, FileEntry>& pair : previous)
+	{
+		for (const ChunkRef& chunk : pair.Value.Chunks)
+		{
+			store.AddKnown(chunk.Id);
+		}
+	}
+
+	slowTask.EnterProgressFrame(1.f);
+	TArray<FileEntry> files;
+	files.SetNum(listing.Num());
+	TAtomic<int32> numFailed(0);
+	TAtomic<int32> numUnchanged(0);
+	ParallelFor(listing.Num(), [&](int32 index) {
+		const DirectoryEntry& source = listing[index];
+		FileEntry& entry = files[index];
+		entry.Path = source.Path.Mid(root.Len() + 1);
+		entry.Size = source.Size;
+		entry.ModifiedTicks = source.ModificationTime.GetTicks();
+
+		// Unchanged since the last publish, reuse its chunk list without reading the file
+		const FileEntry* old = previous.Find(entry.Path);
+		if (old && old->Size == entry.Size && old->ModifiedTicks == entry.ModifiedTicks)
+		{
+			entry.Hash = old->Hash;
+			entry.Chunks = old->Chunks;
+			++numUnchanged;
+			return;
+		}
+
+		if (!chunkFile(source.Path, settings, store, entry))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Library upload: failed to publish %s"), *source.Path);
+			++numFailed;
+		}
+	});
+
+	slowTask.EnterProgressFrame(1.f);
+	// A partial publish keeps the old manifest, the chunks written so far are reused next time
+	const bool bSuccess = numFailed.Load() == 0 && saveManifest(manifestPath, settings.LibraryName, files);
+
+	stats.NumFiles = files.Num();
+	stats.NumUnchangedFiles = numUnchanged.Load();
+	for (const FileEntry& entry : files)
+	{
+		stats.NumChunks += entry.Chunks.Num();
+		stats.TotalBytes += entry.Size;
+	}
+	stats.Seconds = FPlatformTime::Seconds() - startTime;
+	UE_LOG(LogTemp, Log, TEXT("Library upload %s%s: %d files (%d unchanged), %d chunks, %d new, %.1f of %.1f MB written in %.1fs"),
+		*settings.LibraryName, bSuccess ? TEXT("") : TEXT(" failed"), stats.NumFiles, stats.NumUnchangedFiles, stats.NumChunks, stats.NumNewChunks,
+		stats.NewBytes / (1024.0 * 1024.0), stats.TotalBytes / (1024.0 * 1024.0), stats.Seconds);
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	return bSuccess;
+}
+
+// Mount.Library.Upload <SourceDir> <StoreDir> <LibraryName>
+static FAutoConsoleCommand GMountLibraryUploadCommand(
+	TEXT("Mount.Library.Upload"),
+	TEXT("Publish a folder into a chunked library store. Args: <SourceDir> <StoreDir> <LibraryName>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 3)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.Library.Upload <SourceDir> <StoreDir> <LibraryName>"));
+			return;
+		}
+		LibraryUploadSettings settings;
+		settings.StoreDir = Args[1];
+		settings.LibraryName = Args[2];
+		LibraryUploader::Upload(Args[0], settings);
+	})
+);
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,250 @@
+#include "MeshCombiner.h"
+#include "AssetRegistryModule.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Editor.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "MeshDescription.h"
+#include "Misc/ScopedSlowTask.h"
+#include "StaticMeshAttributes.h"
+#include "StaticMeshOperations.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+namespace
+{
+	struct CombineSource
+	{
+		const FMeshDescription* Mesh = nullptr;
+		FTransform Transform;
+		// Source polygon group (in element order) -> merged material slot
+		TArray<int32> GroupToSlot;
+	};
+
+	void registerSlots(FMeshDescription& mesh, const TArray<FName>& slotNames)
+	{
+		FStaticMeshAttributes attributes(mesh);
+		attributes.Register();
+		TPolygonGroupAttributesRef<FName> groupSlotNames = attributes.GetPolygonGroupMaterialSlotNames();
+		for (const FName& slotName : slotNames)
+		{
+			const FPolygonGroupID groupID = mesh.CreatePolygonGroup();
+			groupSlotNames[groupID] = slotName;
+		}
+	}
+
+	void appendSource(const CombineSource& source, FMeshDescription& target)
+	{
+		FStaticMeshOperations::FAppendSettings settings;
+		settings.MeshTransform = source.Transform;
+		settings.PolygonGroupsDelegate = FAppendPolygonGroupsDelegate::CreateLambda(
+			[&source](const FMeshDescription& sourceMesh, FMeshDescription& targetMesh, PolygonGroupMap& remap) {
+				int32 groupIndex = 0;
+				for (const FPolygonGroupID groupID : sourceMesh.PolygonGroups().GetElementIDs())
+				{
+					const int32 slot = source.GroupToSlot.IsValidIndex(groupIndex) ? source.GroupToSlot[groupIndex] : 0;
+					remap.Add(groupID, FPolygonGroupID(slot));
+					++groupIndex;
+				}
+			});
+		FStaticMeshOperations::AppendMeshDescription(*source.Mesh, target, settings);
+	}
+}
+
+UStaticMesh* MeshCombiner::Combine(const TArray<AActor*>& actors, const FString& meshName, const FString& packagePath, MeshCombineStats* outStats)
+{
+	MeshCombineStats stats;
+	stats.NumActors = actors.Num();
+
+	FScopedSlowTask slowTask(100.f, FText::Format(LOCTEXT("CombineActors", "Combining {0} actors"), FText::AsNumber(actors.Num())));
+	slowTask.MakeDialog(true);
+
+	// Game thread: resolve mesh descriptions, transforms and materials
+	double startTime = FPlatformTime::Seconds();
+	const FTransform pivot = actors.Num() > 0 && actors[0] ? FTransform(actors[0]->GetActorLocation()) : FTransform::Identity;
+	TArray<CombineSource> sources;
+	TArray<UMaterialInterface*> materials;
+	TArray<FName> slotNames;
+	TMap<UMaterialInterface*, int32> materialToSlot;
+	for (AActor* actor : actors)
+	{
+		if (!actor) continue;
+
+		TArray<UStaticMeshComponent*> components;
+		actor->GetComponents<UStaticMeshComponent>(components);
+		for (UStaticMeshComponent* component : components)
+		{
+			UStaticMesh* staticMesh = component->GetStaticMesh();
+			const FMeshDescription* meshDescription = staticMesh ? staticMesh->GetMeshDescription(0) : nullptr;
+			if (!meshDescription) continue;
+
+			CombineSource& source = sources.AddDefaulted_GetRef();
+			source.Mesh = meshDescription;
+			source.Transform = component->GetComponentTransform().GetRelativeTransform(pivot);
+
+			// Section i of LOD0 is polygon group i of the mesh description
+			const int32 numSections = meshDescription->PolygonGroups().Num();
+			for (int32 section = 0; section < numSections; ++section)
+			{
+				const int32 materialIndex = staticMesh->GetSectionInfoMap().Get(0, section).MaterialIndex;
+				UMaterialInterface* material = component->GetMaterial(materialIndex);
+				int32* slot = materialToSlot.Find(material);
+				if (!slot)
+				{
+					slot = &materialToSlot.Add(material, materials.Add(material));
+					slotNames.Add(FName(*FString::Printf(TEXT("Slot_%d"), *slot)));
+				}
+				source.GroupToSlot.Add(*slot);
+			}
+		}
+	}
+	stats.NumMeshes = sources.Num();
+	stats.GatherSeconds = FPlatformTime::Seconds() - startTime;
+	slowTask.EnterProgressFrame(10.f);
+
+	if (sources.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Combine actors: no static meshes in selection"));
+		return nullptr;
+	}
+
+	// Workers: bake transforms and gather vertex/index data per chunk, then merge the chunks
+	startTime = FPlatformTime::Seconds();
+	const int32 chunkSize = FMath::Max(1, sources.Num() / (FTaskGraphInterface::Get().GetNumWorkerThreads() * 4));
+	stats.NumChunks = FMath::DivideAndRoundUp(sources.Num(), chunkSize);
+
+	TArray<FMeshDescription> chunks;
+	chunks.SetNum(stats.NumChunks);
+	FMeshDescription merged;
+	TAtomic<int32> chunksDone{ 0 };
+	TAtomic<bool> bCancel{ false };
+	const uint64 startUsed = FPlatformMemory::GetStats().UsedPhysical;
+	uint64 peakUsed = startUsed;
+
+	TFuture<void> mergeTask = Async(EAsyncExecution::ThreadPool, [&]() {
+		ParallelFor(stats.NumChunks, [&](int32 chunkIndex) {
+			FMeshDescription& chunk = chunks[chunkIndex];
+			registerSlots(chunk, slotNames);
+			const int32 end = FMath::Min((chunkIndex + 1) * chunkSize, sources.Num());
+			for (int32 i = chunkIndex * chunkSize; i < end && !bCancel; ++i)
+			{
+				appendSource(sources[i], chunk);
+			}
+			++chunksDone;
+		});
+
+		if (bCancel) return;
+
+		// Chunks already share the slot layout, so the groups map one to one
+		registerSlots(merged, slotNames);
+		FStaticMeshOperations::FAppendSettings settings;
+		settings.PolygonGroupsDelegate = FAppendPolygonGroupsDelegate::CreateLambda(
+			[](const FMeshDescription& sourceMesh, FMeshDescription& targetMesh, PolygonGroupMap& remap) {
+				for (const FPolygonGroupID groupID : sourceMesh.PolygonGroups().GetElementIDs())
+				{
+					remap.Add(groupID, groupID);
+				}
+			});
+		for (FMeshDescription& chunk : chunks)
+		{
+			if (bCancel) return;
+			FStaticMeshOperations::AppendMeshDescription(chunk, merged, settings);
+			chunk.Empty();
+		}
+	});
+
+	int32 reported = 0;
+	while (!mergeTask.WaitFor(FTimespan::FromMilliseconds(50.0)))
+	{
+		peakUsed = FMath::Max(peakUsed, FPlatformMemory::GetStats().UsedPhysical);
+		const int32 done = chunksDone;
+		slowTask.EnterProgressFrame(70.f * (done - reported) / stats.NumChunks);
+		reported = done;
+		if (slowTask.ShouldCancel())
+		{
+			bCancel = true;
+		}
+	}
+	peakUsed = FMath::Max(peakUsed, FPlatformMemory::GetStats().UsedPhysical);
+	stats.PeakExtraBytes = peakUsed - startUsed;
+	stats.MergeSeconds = FPlatformTime::Seconds() - startTime;
+	stats.bCancelled = bCancel;
+
+	UStaticMesh* staticMesh = nullptr;
+	if (!stats.bCancelled)
+	{
+		// Game thread: create and build the asset
+		slowTask.EnterProgressFrame(90.f - slowTask.CompletedWork, LOCTEXT("CombineActorsBuild", "Building combined mesh"));
+		startTime = FPlatformTime::Seconds();
+
+		const FString packageName = packagePath / meshName;
+		UPackage* package = CreatePackage(nullptr, *packageName);
+		staticMesh = NewObject<UStaticMesh>(package, *meshName, RF_Public | RF_Standalone);
+		staticMesh->InitResources();
+		staticMesh->LightingGuid = FGuid::NewGuid();
+
+		FStaticMeshSourceModel& sourceModel = staticMesh->AddSourceModel();
+		sourceModel.BuildSettings.bRecomputeNormals = false;
+		sourceModel.BuildSettings.bRecomputeTangents = false;
+		sourceModel.BuildSettings.bGenerateLightmapUVs = true;
+		for (int32 slot = 0; slot < materials.Num(); ++slot)
+		{
+			staticMesh->StaticMaterials.Add(FStaticMaterial(materials[slot], slotNames[slot], slotNames[slot]));
+			staticMesh->GetSectionInfoMap().Set(0, slot, FMeshSectionInfo(slot));
+		}
+
+		staticMesh->CreateMeshDescription(0, MoveTemp(merged));
+		staticMesh->CommitMeshDescription(0);
+		staticMesh->Build(false);
+		staticMesh->PostEditChange();
+		FAssetRegistryModule::AssetCreated(staticMesh);
+		package->MarkPackageDirty();
+		stats.BuildSeconds = FPlatformTime::Seconds() - startTime;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Combine actors%s: %d actors, %d meshes, %d chunks (gather %.2fs, merge %.2fs, build %.2fs), peak memory +%.1f MB"),
+		stats.bCancelled ? TEXT(" cancelled") : TEXT(""), stats.NumActors, stats.NumMeshes, stats.NumChunks,
+		stats.GatherSeconds, stats.MergeSeconds, stats.BuildSeconds, stats.PeakExtraBytes / (1024.0 * 1024.0));
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	return staticMesh;
+}
+
+bool MeshCombiner::CombineActors(const TArray<AActor*>& actors, AStaticMeshActor*& outActor, const FString& meshName, const FString& packagePath, bool spawnMesh, bool destroyReplacedActors)
+{
+	outActor = nullptr;
+	UStaticMesh* staticMesh = Combine(actors, meshName, packagePath);
+	if (!staticMesh) return false;
+
+	UWorld* world = actors[0] ? actors[0]->GetWorld() : nullptr;
+	if (spawnMesh && world)
+	{
+		FActorSpawnParameters params;
+		params.Name = MakeUniqueObjectName(world->GetCurrentLevel(), AStaticMeshActor::StaticClass(), *meshName);
+		outActor = world->SpawnActor<AStaticMeshActor>(actors[0]->GetActorLocation(), FRotator::ZeroRotator, params);
+		if (outActor)
+		{
+			outActor->GetStaticMeshComponent()->SetStaticMesh(staticMesh);
+			outActor->SetActorLabel(meshName);
+		}
+	}
+
+	if (destroyReplacedActors)
+	{
+		for (AActor* actor : actors)
+		{
+			if (actor && world)
+			{
+				world->EditorDestroyActor(actor, true);
+			}
+		}
+	}
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -8,6 +8,9 @@
 #include "Misc/MessageDialog.h"
 #include "ToolMenus.h"
 #include "Utilities.h"
+#include "AssetNameIndex.h"
+#include "AssetDataResolver.h"
+#include "MountAuditStore.h"
 
 static const FName MountTabName("Mount");
 
@@ -45,6 +48,17 @@ void FMountModule::ShutdownModule()
 
 	UToolMenus::UnregisterOwner(this);
 
+	// Stops background mounting and writes the stop signs before the audit store closes
+	MountManager::Get().Shutdown();
+
+	AssetNameIndex::Get().Shutdown();
+	AssetDataResolver::Get().Shutdown();
+
+	MountAuditStore::Get().Close();
+
+	// Last, a staged update may replace this module's binaries
+	Utilities::Get().Shutdown();
+
 	FMountStyle::Shutdown();
 
 	FMountCommands::Unregister();
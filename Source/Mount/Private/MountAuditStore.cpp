@@ -0,0 +1,514 @@
+#include "MountAuditStore.h"
+#include "Async/Async.h"
+#include "AtomicFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "IPAddress.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "MountSignFormatter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SocketSubsystem.h"
+
+const uint32 MountAuditStore::SegmentMagic = 0x4D4E5441; // "MNTA"
+const uint32 MountAuditStore::IndexMagic = 0x4D4E5449; // "MNTI"
+const uint16 MountAuditStore::Version = 1;
+
+namespace
+{
+	const int64 MaxSegmentSize = 1024 * 1024;
+	const int64 MaxCompactedSize = 16 * 1024 * 1024;
+	const int32 CompactThreshold = 8;
+
+	// Written by MountSignFormatter::AppendString
+	bool readString(const uint8*& cursor, const uint8* end, FString& out)
+	{
+		uint16 len = 0;
+		if (end - cursor < (int64)sizeof(len)) return false;
+		FMemory::Memcpy(&len, cursor, sizeof(len));
+		cursor += sizeof(len);
+		if (end - cursor < len) return false;
+
+		FUTF8ToTCHAR tchar((const ANSICHAR*)cursor, len);
+		out = FString(tchar.Length(), tchar.Get());
+		cursor += len;
+		return true;
+	}
+
+	// Segment header: magic, version, then who wrote it, shared by every record
+	void writeHeader(TArray<uint8>& out, const FString& computer, const FString& user, const FString& ip)
+	{
+		const uint32 magic = MountAuditStore::SegmentMagic;
+		const uint16 version = MountAuditStore::Version;
+		out.Append((const uint8*)&magic, sizeof(magic));
+		out.Append((const uint8*)&version, sizeof(version));
+		MountSignFormatter::AppendString(out, computer);
+		MountSignFormatter::AppendString(out, user);
+		MountSignFormatter::AppendString(out, ip);
+	}
+
+	FString indexFileFor(const FString& segmentFile)
+	{
+		return FPaths::ChangeExtension(segmentFile, TEXT("idx"));
+	}
+}
+
+MountAuditStore& MountAuditStore::Get()
+{
+	static TUniquePtr<MountAuditStore> Singleton = MakeUnique<MountAuditStore>();
+	return *Singleton;
+}
+
+MountAuditStore::~MountAuditStore()
+{
+	Close();
+}
+
+void MountAuditStore::Open(const FString& logRoot)
+{
+	Close();
+	if (logRoot.IsEmpty()) return;
+
+	mAuditDir = logRoot / TEXT("Audit");
+	IFileManager::Get().MakeDirectory(*mAuditDir, true);
+
+	mComputer = FPlatformProcess::ComputerName();
+	mUser = FPlatformProcess::UserName();
+	bool bBindAll = false;
+	TSharedRef<FInternetAddr> localIp = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLocalHostAddr(*GLog, bBindAll);
+	mIp = localIp->IsValid() ? localIp->ToString(false) : FString();
+	mWriterPrefix = FPaths::MakeValidFileName(mComputer + TEXT("_") + mUser + TEXT("_"));
+
+	// Segments of earlier sessions are sealed, merge them off the game thread
+	mCompactTask = Async(EAsyncExecution::ThreadPool, [this]() {
+		compact();
+	});
+}
+
+void MountAuditStore::Close()
+{
+	sealSegment();
+	if (mCompactTask.IsValid())
+	{
+		mCompactTask.Wait();
+		mCompactTask = TFuture<void>();
+	}
+	mAuditDir.Empty();
+
+	FScopeLock lock(&mSegmentsLock);
+	mSegments.Empty();
+}
+
+void MountAuditStore::openSegment()
+{
+	static int32 serial = 0;
+	const FString name = mWriterPrefix + FString::Printf(TEXT("%s_%u_%d.seg"),
+		*FDateTime::UtcNow().ToString(TEXT("%Y%m%d%H%M%S")), FPlatformProcess::GetCurrentProcessId(), serial++);
+
+	mActive = SegmentInfo();
+	mActive.File = mAuditDir / name;
+	mActive.Computer = mComputer;
+	mActive.User = mUser;
+
+	// Other sessions may read our active segment while we append
+	mActiveHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*mActive.File, false, true));
+	if (!mActiveHandle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Mount audit: cannot create %s"), *mActive.File);
+		return;
+	}
+
+	TArray<uint8> header;
+	writeHeader(header, mComputer, mUser, mIp);
+	mActiveHandle->Write(header.GetData(), header.Num());
+	mActiveHandle->Flush();
+	mActive.Size = header.Num();
+}
+
+void MountAuditStore::sealSegment()
+{
+	if (!mActiveHandle) return;
+
+	mActiveHandle.Reset();
+	mActive.bSealed = true;
+	saveIndex(mActive);
+
+	FScopeLock lock(&mSegmentsLock);
+	mSegments.Add(mActive.File, mActive);
+	mActive = SegmentInfo();
+}
+
+void MountAuditStore::Append(const FString& path, const FString& event, const FDateTime& time)
+{
+	if (!IsOpen()) return;
+	if (!mActiveHandle)
+	{
+		openSegment();
+		if (!mActiveHandle) return;
+	}
+
+	// Callers pass local time, the store keeps UTC
+	const int64 ticks = (time - (FDateTime::Now() - FDateTime::UtcNow())).GetTicks();
+	mRecordBuffer.Reset();
+	MountSignFormatter::AppendRecord(mRecordBuffer, ticks, event, path);
+	mActiveHandle->Write(mRecordBuffer.GetData(), mRecordBuffer.Num());
+	mActiveHandle->Flush();
+
+	mActive.Size += mRecordBuffer.Num();
+	mActive.MinTicks = FMath::Min(mActive.MinTicks, ticks);
+	mActive.MaxTicks = FMath::Max(mActive.MaxTicks, ticks);
+	// FString hashing and compares ignore case, only a path new to the segment is lowered and copied
+	if (!mActive.Paths.Contains(path))
+	{
+		mActive.Paths.Add(path.ToLower());
+	}
+	++mActive.NumRecords;
+
+	if (mActive.Size >= MaxSegmentSize)
+	{
+		sealSegment();
+	}
+}
+
+void MountAuditStore::saveIndex(const SegmentInfo& info) const
+{
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	uint32 magic = IndexMagic;
+	uint16 version = Version;
+	int64 minTicks = info.MinTicks;
+	int64 maxTicks = info.MaxTicks;
+	int32 numRecords = info.NumRecords;
+	int64 size = info.Size;
+	FString computer = info.Computer;
+	FString user = info.User;
+	TArray<FString> paths = info.Paths.Array();
+	writer << magic << version << minTicks << maxTicks << numRecords << size << computer << user << paths;
+
+	// Readers must never see a half written index
+	const FString indexFile = indexFileFor(info.File);
+	AtomicFile::SaveArrayToFile(bytes, indexFile);
+}
+
+bool MountAuditStore::loadIndex(const FString& indexFile, SegmentInfo& info) const
+{
+	TArray<uint8> bytes;
+	if (!FFileHelper::LoadFileToArray(bytes, *indexFile, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader reader(bytes);
+	uint32 magic = 0;
+	uint16 version = 0;
+	reader << magic << version;
+	if (magic != IndexMagic || version != Version)
+	{
+		return false;
+	}
+
+	TArray<FString> paths;
+	reader << info.MinTicks << info.MaxTicks << info.NumRecords << info.Size << info.Computer << info.User << paths;
+	if (reader.IsError())
+	{
+		return false;
+	}
+
+	info.Paths = TSet<FString>(paths);
+	info.bSealed = true;
+	return true;
+}
+
+bool MountAuditStore::readSegment(const FString& file, SegmentInfo& info, TArray<MountAuditRecord>* outRecords) const
+{
+	// Active segments are held open for writing by their session, ours included, share the write
+	TArray<uint8> bytes;
+	if (!FFileHelper::LoadFileToArray(bytes, *file, FILEREAD_Silent | FILEREAD_AllowWrite))
+	{
+		return false;
+	}
+
+	const uint8* cursor = bytes.GetData();
+	const uint8* end = cursor + bytes.Num();
+	uint32 magic = 0;
+	uint16 version = 0;
+	if (end - cursor < (int64)(sizeof(magic) + sizeof(version))) return false;
+	FMemory::Memcpy(&magic, cursor, sizeof(magic));
+	cursor += sizeof(magic);
+	FMemory::Memcpy(&version, cursor, sizeof(version));
+	cursor += sizeof(version);
+	if (magic != SegmentMagic || version != Version) return false;
+
+	FString ip;
+	if (!readString(cursor, end, info.Computer) || !readString(cursor, end, info.User) || !readString(cursor, end, ip))
+	{
+		return false;
+	}
+
+	info.File = file;
+	info.Size = bytes.Num();
+	while (end - cursor >= (int64)sizeof(uint32))
+	{
+		uint32 size = 0;
+		FMemory::Memcpy(&size, cursor, sizeof(size));
+		cursor += sizeof(size);
+		// A writer may be in the middle of appending, ignore the partial tail
+		if ((uint64)(end - cursor) < size || size < sizeof(int64)) break;
+
+		const uint8* recordEnd = cursor + size;
+		int64 ticks = 0;
+		FMemory::Memcpy(&ticks, cursor, sizeof(ticks));
+		cursor += sizeof(ticks);
+
+		FString event, path;
+		if (!readString(cursor, recordEnd, event) || !readString(cursor, recordEnd, path)) break;
+		cursor = recordEnd;
+
+		info.MinTicks = FMath::Min(info.MinTicks, ticks);
+		info.MaxTicks = FMath::Max(info.MaxTicks, ticks);
+		info.Paths.Add(path.ToLower());
+		++info.NumRecords;
+
+		if (outRecords)
+		{
+			MountAuditRecord& record = outRecords->AddDefaulted_GetRef();
+			record.Time = FDateTime(ticks);
+			record.Computer = info.Computer;
+			record.User = info.User;
+			record.Ip = ip;
+			record.Event = MoveTemp(event);
+			record.Path = MoveTemp(path);
+		}
+	}
+	return true;
+}
+
+bool MountAuditStore::writeSegment(const FString& file, const FString& computer, const FString& user, const FString& ip, const TArray<MountAuditRecord>& records) const
+{
+	TArray<uint8> bytes;
+	writeHeader(bytes, computer, user, ip);
+	for (const MountAuditRecord& record : records)
+	{
+		MountSignFormatter::AppendRecord(bytes, record.Time.GetTicks(), record.Event, record.Path);
+	}
+
+	return AtomicFile::SaveArrayToFile(bytes, file);
+}
+
+void MountAuditStore::refreshSegments()
+{
+	TArray<FString> files;
+	IFileManager::Get().FindFiles(files, *(mAuditDir / TEXT("*.seg")), true, false);
+
+	TSet<FString> present;
+	for (const FString& name : files)
+	{
+		const FString file = mAuditDir / name;
+		if (file == mActive.File) continue;
+		present.Add(file);
+
+		const int64 size = IFileManager::Get().FileSize(*file);
+		{
+			FScopeLock lock(&mSegmentsLock);
+			const SegmentInfo* known = mSegments.Find(file);
+			if (known && known->Size == size) continue;
+		}
+
+		// Sealed segments only need their index, segments still being written are scanned
+		SegmentInfo info;
+		info.File = file;
+		if (!loadIndex(indexFileFor(file), info) || info.Size != size)
+		{
+			info = SegmentInfo();
+			if (!readSegment(file, info, nullptr)) continue;
+		}
+
+		FScopeLock lock(&mSegmentsLock);
+		mSegments.Add(file, info);
+	}
+
+	FScopeLock lock(&mSegmentsLock);
+	for (auto it = mSegments.CreateIterator(); it; ++it)
+	{
+		if (!present.Contains(it.Key()))
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
+
+TArray<MountAuditRecord> MountAuditStore::Query(const MountAuditQuery& query)
+{
+	TArray<MountAuditRecord> results;
+	if (!IsOpen()) return results;
+
+	refreshSegments();
+
+	const int64 fromTicks = query.From.GetTicks();
+	const int64 toTicks = query.To.GetTicks();
+	const FString pathFilter = query.PathContains.ToLower();
+	auto segmentMatches = [&](const SegmentInfo& info) {
+		if (info.NumRecords == 0 || info.MaxTicks < fromTicks || info.MinTicks > toTicks) return false;
+		if (!query.User.IsEmpty() && !info.User.Equals(query.User, ESearchCase::IgnoreCase)) return false;
+		if (pathFilter.IsEmpty()) return true;
+		for (const FString& path : info.Paths)
+		{
+			if (path.Contains(pathFilter)) return true;
+		}
+		return false;
+	};
+
+	TArray<SegmentInfo> candidates;
+	{
+		FScopeLock lock(&mSegmentsLock);
+		for (const TPair<FString, SegmentInfo>& pair : mSegments)
+		{
+			if (segmentMatches(pair.Value))
+			{
+				candidates.Add(pair.Value);
+			}
+		}
+	}
+	if (mActiveHandle && segmentMatches(mActive))
+	{
+		candidates.Add(mActive);
+	}
+
+	// Newest segments first so older ones can be skipped once enough results are in
+	candidates.Sort([](const SegmentInfo& a, const SegmentInfo& b) { return a.MaxTicks > b.MaxTicks; });
+	TArray<MountAuditRecord> records;
+	for (const SegmentInfo& candidate : candidates)
+	{
+		if (results.Num() >= query.MaxResults && candidate.MaxTicks < results.Last().Time.GetTicks())
+		{
+			break;
+		}
+
+		SegmentInfo info;
+		records.Reset();
+		readSegment(candidate.File, info, &records);
+		for (MountAuditRecord& record : records)
+		{
+			const int64 ticks = record.Time.GetTicks();
+			if (ticks < fromTicks || ticks > toTicks) continue;
+			if (!pathFilter.IsEmpty() && !record.Path.ToLower().Contains(pathFilter)) continue;
+			if (!query.User.IsEmpty() && !record.User.Equals(query.User, ESearchCase::IgnoreCase)) continue;
+			results.Add(MoveTemp(record));
+		}
+
+		results.Sort([](const MountAuditRecord& a, const MountAuditRecord& b) { return a.Time > b.Time; });
+		if (results.Num() > query.MaxResults)
+		{
+			results.SetNum(query.MaxResults);
+		}
+	}
+	return results;
+}
+
+void MountAuditStore::compact()
+{
+	// One compactor per machine and user, a crashed one leaves a lock that expires after an hour
+	const FString lockFile = mAuditDir / mWriterPrefix + TEXT("compact.lock");
+	IFileManager& fileMgr = IFileManager::Get();
+	const FDateTime lockTime = fileMgr.GetTimeStamp(*lockFile);
+	if (lockTime != FDateTime::MinValue())
+	{
+		if (FDateTime::UtcNow() - lockTime < FTimespan::FromHours(1.0)) return;
+		fileMgr.Delete(*lockFile);
+	}
+	TUniquePtr<FArchive> lock(fileMgr.CreateFileWriter(*lockFile, FILEWRITE_NoReplaceExisting));
+	if (!lock) return;
+	lock.Reset();
+
+	// Only sealed segments of earlier sessions of this machine and user
+	TArray<FString> names;
+	fileMgr.FindFiles(names, *(mAuditDir / (mWriterPrefix + TEXT("*.seg"))), true, false);
+	names.Sort();
+	TArray<SegmentInfo> sealed;
+	for (const FString& name : names)
+	{
+		SegmentInfo info;
+		info.File = mAuditDir / name;
+		if (loadIndex(indexFileFor(info.File), info) && info.Size == fileMgr.FileSize(*info.File))
+		{
+			sealed.Add(info);
+		}
+	}
+
+	if (sealed.Num() >= CompactThreshold)
+	{
+		int32 batchStart = 0;
+		while (batchStart < sealed.Num())
+		{
+			int32 batchEnd = batchStart;
+			int64 batchSize = 0;
+			while (batchEnd < sealed.Num() && (batchEnd == batchStart || batchSize + sealed[batchEnd].Size <= MaxCompactedSize))
+			{
+				batchSize += sealed[batchEnd++].Size;
+			}
+
+			if (batchEnd - batchStart > 1)
+			{
+				TArray<MountAuditRecord> records;
+				FString ip;
+				for (int32 i = batchStart; i < batchEnd; ++i)
+				{
+					SegmentInfo info;
+					const int32 first = records.Num();
+					readSegment(sealed[i].File, info, &records);
+					if (records.Num() > first) ip = records.Last().Ip;
+				}
+				records.Sort([](const MountAuditRecord& a, const MountAuditRecord& b) { return a.Time < b.Time; });
+
+				const FString merged = mAuditDir / mWriterPrefix + FString::Printf(TEXT("%s_c%s.seg"),
+					*FDateTime(sealed[batchStart].MinTicks).ToString(TEXT("%Y%m%d%H%M%S")), *FGuid::NewGuid().ToString().Left(8));
+				if (writeSegment(merged, mComputer, mUser, ip, records))
+				{
+					SegmentInfo mergedInfo;
+					readSegment(merged, mergedInfo, nullptr);
+					mergedInfo.bSealed = true;
+					saveIndex(mergedInfo);
+
+					FScopeLock segmentsLock(&mSegmentsLock);
+					for (int32 i = batchStart; i < batchEnd; ++i)
+					{
+						fileMgr.Delete(*sealed[i].File);
+						fileMgr.Delete(*indexFileFor(sealed[i].File));
+						mSegments.Remove(sealed[i].File);
+					}
+					mSegments.Add(merged, mergedInfo);
+				}
+			}
+			batchStart = batchEnd;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Mount audit: compacted %d segments"), sealed.Num());
+	}
+
+	fileMgr.Delete(*lockFile);
+}
+
+// Mount.Audit.Query <PathSubstring> [Days] [User]
+static FAutoConsoleCommand GMountAuditQueryCommand(
+	TEXT("Mount.Audit.Query"),
+	TEXT("List mount events. Args: <PathSubstring> [Days=7] [User]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		MountAuditQuery query;
+		query.PathContains = Args.Num() > 0 ? Args[0] : FString();
+		const double days = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 7.0;
+		query.From = FDateTime::UtcNow() - FTimespan::FromDays(days);
+		query.User = Args.Num() > 2 ? Args[2] : FString();
+
+		const double startTime = FPlatformTime::Seconds();
+		TArray<MountAuditRecord> records = MountAuditStore::Get().Query(query);
+		const FTimespan utcOffset = FDateTime::Now() - FDateTime::UtcNow();
+		for (const MountAuditRecord& record : records)
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s  -  %s  -  %s  -  %s  -  %s  -  %s"), *(record.Time + utcOffset).ToString(),
+				*record.Computer, *record.User, *record.Ip, *record.Event, *record.Path);
+		}
+		UE_LOG(LogTemp, Log, TEXT("Mount audit: %d records in %.1f ms"), records.Num(), (FPlatformTime::Seconds() - startTime) * 1000.0);
+	})
+);
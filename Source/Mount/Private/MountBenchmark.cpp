@@ -0,0 +1,600 @@
+#include "MountBenchmark.h"
+#include "Async/AsyncFileHandle.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "MountAuditStore.h"
+#include "MountCachePlatformFile.h"
+#include "MountConfigSnapshot.h"
+#include "MountManager.h"
+#include "PassThroughPlatformFile.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	// 2: Init registers startup roots with the engine
+	const int32 ResultVersion = 2;
+	const int32 PackageBytes = 1024;
+	const double LogResolveTimeoutSeconds = 30.0;
+	const int32 SignEvents = 1000;
+	// Package files the cache phases read, below no mount point
+	const int32 CachedFiles = 64;
+	const int32 CachedFileBytes = 64 * 1024;
+
+	// Allocation counting...
+	struct ThreadAllocationCounts
+	{
+		bool bCounting;
+		uint64 Allocations;
+		uint64 Bytes;
+	};
+	// Plain data, reading it from inside the allocator never allocates
+	thread_local ThreadAllocationCounts GThreadAllocations = { false, 0, 0 };
+
+	class CountingMalloc : public FMalloc
+	{
+	public:
+		explicit CountingMalloc(FMalloc* inner) : Inner(inner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { count(Count); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { count(Count); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { count(Count); return Inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { count(Count); return Inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& out_Stats) override { Inner->GetAllocatorStats(out_Stats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("MountCounting"); }
+
+		FMalloc* Inner;
+
+	private:
+		void count(SIZE_T size)
+		{
+			if (GThreadAllocations.bCounting && size > 0)
+			{
+				++GThreadAllocations.Allocations;
+				GThreadAllocations.Bytes += size;
+			}
+		}
+	};
+
+	// Never freed, another thread may still be inside it after GMalloc is switched back
+	CountingMalloc* GCountingMalloc = nullptr;
+
+	// Filesystem latency...
+	class LatencyPlatformFile : public PassThroughPlatformFile
+	{
+	public:
+		explicit LatencyPlatformFile(float latencyMs) : mLatencySeconds(latencyMs / 1000.f) {}
+
+		virtual const TCHAR* GetName() const override { return TEXT("MountBenchmarkLatency"); }
+
+		virtual bool FileExists(const TCHAR* Filename) override { delay(); return LowerLevel->FileExists(Filename); }
+		virtual int64 FileSize(const TCHAR* Filename) override { delay(); return LowerLevel->FileSize(Filename); }
+		virtual FDateTime GetTimeStamp(const TCHAR* Filename) override { delay(); return LowerLevel->GetTimeStamp(Filename); }
+		virtual IFileHandle* OpenRead(const TCHAR* Filename, bool bAllowWrite = false) override { delay(); return LowerLevel->OpenRead(Filename, bAllowWrite); }
+		virtual IAsyncReadFileHandle* OpenAsyncRead(const TCHAR* Filename) override { delay(); ++mNumAsyncOpens; return LowerLevel->OpenAsyncRead(Filename); }
+		virtual IFileHandle* OpenWrite(const TCHAR* Filename, bool bAppend = false, bool bAllowRead = false) override { delay(); return LowerLevel->OpenWrite(Filename, bAppend, bAllowRead); }
+		virtual bool DirectoryExists(const TCHAR* Directory) override { delay(); return LowerLevel->DirectoryExists(Directory); }
+		virtual bool CreateDirectory(const TCHAR* Directory) override { delay(); return LowerLevel->CreateDirectory(Directory); }
+		virtual bool MoveFile(const TCHAR* To, const TCHAR* From) override { delay(); return LowerLevel->MoveFile(To, From); }
+		virtual bool DeleteFile(const TCHAR* Filename) override { delay(); return LowerLevel->DeleteFile(Filename); }
+		virtual FFileStatData GetStatData(const TCHAR* FilenameOrDirectory) override { delay(); return LowerLevel->GetStatData(FilenameOrDirectory); }
+		// One round trip per listing, not per entry
+		virtual bool IterateDirectory(const TCHAR* Directory, FDirectoryVisitor& Visitor) override { delay(); return LowerLevel->IterateDirectory(Directory, Visitor); }
+		virtual bool IterateDirectoryStat(const TCHAR* Directory, FDirectoryStatVisitor& Visitor) override { delay(); return LowerLevel->IterateDirectoryStat(Directory, Visitor); }
+
+		int64 GetNumCalls() const { return mNumCalls.Load(); }
+		// Layers above that do not forward OpenAsyncRead never get here
+		int64 GetNumAsyncOpens() const { return mNumAsyncOpens.Load(); }
+
+	private:
+		void delay()
+		{
+			++mNumCalls;
+			if (mLatencySeconds > 0.f)
+			{
+				FPlatformProcess::Sleep(mLatencySeconds);
+			}
+		}
+
+		float mLatencySeconds;
+		TAtomic<int64> mNumCalls { 0 };
+		TAtomic<int64> mNumAsyncOpens { 0 };
+	};
+
+	// Generation...
+	void makeTree(const FString& dir, int32 depth, const MountBenchmarkSettings& settings, const TArray<uint8>& payload)
+	{
+		IFileManager::Get().MakeDirectory(*dir, true);
+		// Not packages, the registry's background gather skips them
+		for (int32 p = 0; p < settings.PackagesPerFolder; ++p)
+		{
+			FFileHelper::SaveArrayToFile(payload, *(dir / FString::Printf(TEXT("P%03d.bench"), p)));
+		}
+		if (depth <= 1) return;
+		for (int32 f = 0; f < settings.FanOut; ++f)
+		{
+			makeTree(dir / FString::Printf(TEXT("S%02d"), f), depth - 1, settings, payload);
+		}
+	}
+
+	FString makeMountedDir(const FString& root, const TArray<FString>& subDirs)
+	{
+		return FString::Format(TEXT("(RootDir=\"{0}\",SubDirs=\"{1}\")"), { root, FString::Join(subDirs, TEXT(",")) });
+	}
+
+	// Roots [0, NumRoots) go to MountedDirs, every fourth of them mounts in Init like the startup map's
+	// roots would, the rest are returned for registerMountPoint
+	bool generate(const MountBenchmarkSettings& settings, const FString& workDir, TArray<FString>& outStartupRoots, TArray<FString>& outNewRoots)
+	{
+		const FString treeDir = workDir / TEXT("Tree");
+		const FString marker = workDir / TEXT("MountBenchmark.marker");
+		IFileManager& fileManager = IFileManager::Get();
+		if (fileManager.DirectoryExists(*treeDir) && !fileManager.FileExists(*marker))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Mount benchmark: %s exists and was not made by the benchmark, not touching it"), *treeDir);
+			return false;
+		}
+		fileManager.DeleteDirectory(*treeDir, false, true);
+		fileManager.DeleteDirectory(*(workDir / TEXT("Logs")), false, true);
+		fileManager.MakeDirectory(*(workDir / TEXT("Logs")), true);
+		FFileHelper::SaveStringToFile(FString(), *marker);
+
+		TArray<uint8> payload;
+		payload.SetNumZeroed(PackageBytes);
+		const int32 numRules = FMath::Clamp(settings.NumRules, 0, 100);
+
+		TArray<uint8> cachedPayload;
+		cachedPayload.SetNumZeroed(CachedFileBytes);
+		for (int32 i = 0; i < CachedFiles; ++i)
+		{
+			FFileHelper::SaveArrayToFile(cachedPayload, *(treeDir / TEXT("Cached") / FString::Printf(TEXT("C%03d.uasset"), i)));
+		}
+
+		FString mountedDirs;
+		for (int32 i = 0; i < settings.NumRoots + settings.NumNewRoots; ++i)
+		{
+			FString root;
+			TArray<FString> subDirs;
+			if (numRules > 0 && i % 4 == 3)
+			{
+				// Matched by a rule, mounts itself and the rule's required folder
+				const FString ruleDir = treeDir / TEXT("Rules") / FString::Printf(TEXT("BenchRule%02d"), i % numRules);
+				root = ruleDir / FString::Printf(TEXT("B%03d"), i);
+				makeTree(root, settings.Depth, settings, payload);
+				makeTree(ruleDir / FString::Printf(TEXT("BenchShared%02d"), i % numRules), settings.Depth, settings, payload);
+				subDirs.Add(root);
+			}
+			else
+			{
+				// A Content folder, every subfolder becomes a mount point
+				root = treeDir / FString::Printf(TEXT("Lib%03d"), i) / TEXT("Content");
+				for (int32 f = 0; f < settings.FanOut; ++f)
+				{
+					subDirs.Add(root / FString::Printf(TEXT("B%03d_%02d"), i, f));
+					makeTree(subDirs.Last(), settings.Depth, settings, payload);
+				}
+			}
+
+			if (i < settings.NumRoots)
+			{
+				mountedDirs += TEXT("+MountedDirs=") + makeMountedDir(root, subDirs) + LINE_TERMINATOR;
+				if (i % 4 == 0) outStartupRoots.Add(root);
+			}
+			else
+			{
+				outNewRoots.Add(root);
+			}
+		}
+
+		FString pluginIni;
+		pluginIni += TEXT("[MountRule]") LINE_TERMINATOR;
+		for (int32 r = 0; r < numRules; ++r)
+		{
+			pluginIni += FString::Printf(TEXT("+Rule=(SubDir=\"BenchRule%02d\",Requires=\"BenchShared%02d\")"), r, r) + LINE_TERMINATOR;
+		}
+		pluginIni += TEXT("[MountLogRootPath]") LINE_TERMINATOR;
+		pluginIni += TEXT("+Path=") + workDir / TEXT("Logs") + LINE_TERMINATOR;
+		// Most need-log entries miss, like the long lists on the workstations
+		pluginIni += TEXT("[MountNeedLogDir]") LINE_TERMINATOR;
+		for (int32 r = 0; r < numRules; ++r)
+		{
+			pluginIni += FString::Printf(TEXT("+Path=//benchserver/share%02d/"), r) + LINE_TERMINATOR;
+		}
+		pluginIni += TEXT("+Path=") + treeDir + LINE_TERMINATOR;
+		// The txt tree is the slower of the two sign paths, the sign phase covers both
+		pluginIni += TEXT("[MountAudit]") LINE_TERMINATOR;
+		pluginIni += TEXT("LegacyTextLog=True") LINE_TERMINATOR;
+
+		const FString projectIni = TEXT("[MountConfig]") LINE_TERMINATOR + mountedDirs;
+
+		const FString pluginIniPath = workDir / TEXT("MountPluginConfig.ini");
+		const FString projectIniPath = workDir / TEXT("MountConfig.ini");
+		GConfig->UnloadFile(pluginIniPath);
+		GConfig->UnloadFile(projectIniPath);
+		fileManager.Delete(*MountConfigSnapshot::GetSnapshotPath(pluginIniPath));
+		return FFileHelper::SaveStringToFile(pluginIni, *pluginIniPath) && FFileHelper::SaveStringToFile(projectIni, *projectIniPath);
+	}
+
+	MountBenchmarkPhase measure(const TCHAR* name, const LatencyPlatformFile& platformFile, TFunctionRef<void()> func)
+	{
+		MountBenchmarkPhase phase;
+		phase.Name = name;
+		const int64 startCalls = platformFile.GetNumCalls();
+		const double startTime = FPlatformTime::Seconds();
+		{
+			MountAllocationScope allocations;
+			func();
+			phase.Allocations = allocations.GetAllocations();
+			phase.AllocatedBytes = allocations.GetAllocatedBytes();
+		}
+		phase.Seconds = FPlatformTime::Seconds() - startTime;
+		phase.FileCalls = platformFile.GetNumCalls() - startCalls;
+		return phase;
+	}
+
+	// Results...
+	TSharedRef<FJsonObject> phasesToJson(const MountBenchmarkSettings& settings, const TArray<MountBenchmarkPhase>& phases)
+	{
+		TArray<TSharedPtr<FJsonValue>> phaseValues;
+		for (const MountBenchmarkPhase& phase : phases)
+		{
+			TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+			object->SetStringField(TEXT("Name"), phase.Name);
+			object->SetNumberField(TEXT("Seconds"), phase.Seconds);
+			object->SetNumberField(TEXT("Allocations"), (double)phase.Allocations);
+			object->SetNumberField(TEXT("AllocatedBytes"), (double)phase.AllocatedBytes);
+			object->SetNumberField(TEXT("FileCalls"), (double)phase.FileCalls);
+			phaseValues.Add(MakeShared<FJsonValueObject>(object));
+		}
+
+		TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+		root->SetNumberField(TEXT("Version"), ResultVersion);
+		root->SetStringField(TEXT("Settings"), settings.ToString());
+		root->SetStringField(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+		root->SetStringField(TEXT("Computer"), FPlatformProcess::ComputerName());
+		root->SetArrayField(TEXT("Phases"), phaseValues);
+		return root;
+	}
+
+	bool saveJson(const TSharedRef<FJsonObject>& root, const FString& path)
+	{
+		FString json;
+		TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+		FJsonSerializer::Serialize(root, writer);
+		return FFileHelper::SaveStringToFile(json, *path);
+	}
+
+	// True if nothing regressed, a missing or mismatched baseline is not a regression
+	bool compareWithBaseline(const MountBenchmarkSettings& settings, const TArray<MountBenchmarkPhase>& phases, const FString& baselinePath)
+	{
+		FString json;
+		TSharedPtr<FJsonObject> root;
+		if (!FFileHelper::LoadFileToString(json, *baselinePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), root) || !root.IsValid())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Mount benchmark: no baseline at %s, run with SaveBaseline to record one"), *baselinePath);
+			return true;
+		}
+		if (root->GetIntegerField(TEXT("Version")) != ResultVersion || !root->GetStringField(TEXT("Settings")).Equals(settings.ToString()))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Mount benchmark: baseline was recorded with other settings (%s), not comparing"), *root->GetStringField(TEXT("Settings")));
+			return true;
+		}
+
+		TMap<FString, TSharedPtr<FJsonObject>> baseline;
+		for (const TSharedPtr<FJsonValue>& value : root->GetArrayField(TEXT("Phases")))
+		{
+			const TSharedPtr<FJsonObject> object = value->AsObject();
+			if (object.IsValid()) baseline.Add(object->GetStringField(TEXT("Name")), object);
+		}
+
+		bool bPassed = true;
+		for (const MountBenchmarkPhase& phase : phases)
+		{
+			const TSharedPtr<FJsonObject>* found = baseline.Find(phase.Name);
+			if (!found) continue;
+
+			const double baseSeconds = (*found)->GetNumberField(TEXT("Seconds"));
+			const double baseAllocations = (*found)->GetNumberField(TEXT("Allocations"));
+			const bool bSlower = phase.Seconds > baseSeconds * (1.0 + settings.Tolerance);
+			const bool bMoreAllocations = phase.Allocations > baseAllocations * (1.0 + settings.Tolerance);
+			bPassed &= !bSlower && !bMoreAllocations;
+			UE_LOG(LogTemp, Log, TEXT("  %-20s %8.3fs (baseline %8.3fs)%s  %10llu allocations (baseline %10.0f)%s"), *phase.Name,
+				phase.Seconds, baseSeconds, bSlower ? TEXT(" SLOWER") : TEXT(""),
+				phase.Allocations, baseAllocations, bMoreAllocations ? TEXT(" MORE") : TEXT(""));
+		}
+		return bPassed;
+	}
+}
+
+FString MountBenchmarkSettings::ToString() const
+{
+	return FString::Printf(TEXT("Depth=%d FanOut=%d Packages=%d Roots=%d Added=%d Rules=%d LatencyMs=%.2f"),
+		Depth, FanOut, PackagesPerFolder, NumRoots, NumNewRoots, NumRules, LatencyMs);
+}
+
+MountAllocationScope::MountAllocationScope()
+{
+	if (!GCountingMalloc)
+	{
+		GCountingMalloc = new CountingMalloc(GMalloc);
+	}
+	if (GMalloc != GCountingMalloc)
+	{
+		GCountingMalloc->Inner = GMalloc;
+		GMalloc = GCountingMalloc;
+	}
+
+	// Nested scopes see their own share of the outer scope's counts
+	bWasCounting = GThreadAllocations.bCounting;
+	mStartAllocations = GThreadAllocations.Allocations;
+	mStartBytes = GThreadAllocations.Bytes;
+	GThreadAllocations.bCounting = true;
+}
+
+MountAllocationScope::~MountAllocationScope()
+{
+	GThreadAllocations.bCounting = bWasCounting;
+}
+
+uint64 MountAllocationScope::GetAllocations() const
+{
+	return GThreadAllocations.Allocations - mStartAllocations;
+}
+
+uint64 MountAllocationScope::GetAllocatedBytes() const
+{
+	return GThreadAllocations.Bytes - mStartBytes;
+}
+
+void MountAllocationScope::Uninstall()
+{
+	if (GCountingMalloc && GMalloc == GCountingMalloc)
+	{
+		GMalloc = GCountingMalloc->Inner;
+	}
+}
+
+FString MountBenchmark::GetDefaultWorkDir()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("MountBenchmark"));
+}
+
+bool MountBenchmark::Run(const MountBenchmarkSettings& settings)
+{
+	check(IsInGameThread());
+	const FString workDir = settings.WorkDir.IsEmpty() ? GetDefaultWorkDir() : settings.WorkDir;
+
+	const double generateStart = FPlatformTime::Seconds();
+	TArray<FString> startupRoots;
+	TArray<FString> newRoots;
+	if (!generate(settings, workDir, startupRoots, newRoots))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Mount benchmark: failed to generate the tree in %s"), *workDir);
+		return false;
+	}
+	UE_LOG(LogTemp, Log, TEXT("Mount benchmark: generated %s in %.1fs"), *settings.ToString(), FPlatformTime::Seconds() - generateStart);
+
+	TArray<MountBenchmarkPhase> phases;
+	const bool bReplayed = replay(settings, workDir, startupRoots, newRoots, phases);
+	MountAllocationScope::Uninstall();
+	if (!bReplayed) return false;
+
+	TSharedRef<FJsonObject> result = phasesToJson(settings, phases);
+	saveJson(result, workDir / TEXT("Result.json"));
+	for (const MountBenchmarkPhase& phase : phases)
+	{
+		UE_LOG(LogTemp, Log, TEXT("  %-20s %8.3fs %10llu allocations %10.1f KB %8lld file calls"), *phase.Name,
+			phase.Seconds, phase.Allocations, phase.AllocatedBytes / 1024.0, phase.FileCalls);
+	}
+
+	const FString baselinePath = workDir / TEXT("Baseline.json");
+	if (settings.bSaveBaseline)
+	{
+		saveJson(result, baselinePath);
+		UE_LOG(LogTemp, Log, TEXT("Mount benchmark: saved baseline %s"), *baselinePath);
+		return true;
+	}
+
+	const bool bPassed = compareWithBaseline(settings, phases, baselinePath);
+	UE_LOG(LogTemp, Log, TEXT("Mount benchmark %s, results in %s"), bPassed ? TEXT("passed") : TEXT("REGRESSED"), *(workDir / TEXT("Result.json")));
+	return bPassed;
+}
+
+bool MountBenchmark::replay(const MountBenchmarkSettings& settings, const FString& workDir, const TArray<FString>& startupRoots, const TArray<FString>& newRoots, TArray<MountBenchmarkPhase>& outPhases)
+{
+	MountAuditStore auditStore;
+	TUniquePtr<MountManager> manager = MakeUnique<MountManager>();
+	manager->bIsolated = true;
+	manager->mProjectConfigOverride = workDir / TEXT("MountConfig.ini");
+	manager->mPluginConfigOverride = workDir / TEXT("MountPluginConfig.ini");
+	manager->mAuditStore = &auditStore;
+	manager->mIsolatedStartupRoots.Append(startupRoots);
+
+	// Not deleted, editor threads may still be inside it when it leaves the chain
+	LatencyPlatformFile& latency = *new LatencyPlatformFile(settings.LatencyMs);
+	IPlatformFile& current = FPlatformFileManager::Get().GetPlatformFile();
+	latency.Initialize(&current, TEXT(""));
+	FPlatformFileManager::Get().SetPlatformFile(latency);
+
+	bool bResolved = true;
+	outPhases.Add(measure(TEXT("Init"), latency, [&]() {
+		manager->initMounts();
+		// Signs queue until the log root is probed, that is part of startup
+		const double start = FPlatformTime::Seconds();
+		while (!manager->bMountLogPathResolved && FPlatformTime::Seconds() - start < LogResolveTimeoutSeconds)
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.f);
+		}
+		bResolved = manager->bMountLogPathResolved;
+	}));
+
+	outPhases.Add(measure(TEXT("DeferredMounts"), latency, [&]() {
+		if (manager->mMountScheduler.IsValid())
+		{
+			manager->mMountScheduler->Flush();
+		}
+	}));
+	if (manager->mMountScheduler.IsValid())
+	{
+		manager->mMountScheduler->Cancel();
+		manager->mMountScheduler.Reset();
+	}
+
+	outPhases.Add(measure(TEXT("RegisterMountPoint"), latency, [&]() {
+		for (const FString& root : newRoots)
+		{
+			manager->registerMountPoint(root, true);
+		}
+	}));
+
+	outPhases.Add(measure(TEXT("AddMountedData"), latency, [&]() {
+		for (int32 i = 0; i < settings.NumRoots; ++i)
+		{
+			const FString root = workDir / TEXT("Tree") / FString::Printf(TEXT("Extra%03d"), i);
+			manager->addMountedData(MountData(root, root));
+		}
+	}));
+
+	outPhases.Add(measure(TEXT("Unmount"), latency, [&]() {
+		const TArray<MountData> mounted = manager->mMountedDatas;
+		for (const MountData& data : mounted)
+		{
+			manager->onUnmountButtonClick(data);
+		}
+	}));
+
+	// Read-through cache on the slow directory, an instance of its own so the editor's cache is left
+	// alone. A miss must not wait for the copy, a hit only stats the share, async opens reach the layer below.
+	bool bCacheChecked = true;
+	{
+		MountCacheSettings cacheSettings;
+		cacheSettings.CacheDir = workDir / TEXT("Cache");
+		cacheSettings.Roots.Add(workDir / TEXT("Tree") / TEXT("Cached"));
+		IFileManager::Get().DeleteDirectory(*cacheSettings.CacheDir, false, true);
+		TUniquePtr<MountCachePlatformFile> cache(new MountCachePlatformFile(cacheSettings));
+		cache->Initialize(&latency, TEXT(""));
+
+		TArray<FString> files;
+		for (int32 i = 0; i < CachedFiles; ++i)
+		{
+			files.Add(cacheSettings.Roots[0] / FString::Printf(TEXT("C%03d.uasset"), i));
+		}
+		TArray<uint8> buffer;
+		buffer.SetNumUninitialized(CachedFileBytes);
+		auto readAll = [&]() {
+			for (const FString& file : files)
+			{
+				TUniquePtr<IFileHandle> handle(cache->OpenRead(*file));
+				bCacheChecked &= handle && handle->Read(buffer.GetData(), CachedFileBytes);
+			}
+		};
+
+		outPhases.Add(measure(TEXT("CacheMiss"), latency, readAll));
+		cache->waitForFetches();
+		outPhases.Add(measure(TEXT("CacheHit"), latency, readAll));
+		if (cache->mNumMisses.Load() != CachedFiles || cache->mNumHits.Load() != CachedFiles || outPhases.Last().FileCalls > 2 * CachedFiles)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Mount benchmark: cache had %d misses and %d hits for %d files read twice, %lld file calls on hits"),
+				cache->mNumMisses.Load(), cache->mNumHits.Load(), CachedFiles, outPhases.Last().FileCalls);
+			bCacheChecked = false;
+		}
+
+		// Cached and uncached alike
+		const int64 asyncOpens = latency.GetNumAsyncOpens();
+		for (const FString& file : files)
+		{
+			delete cache->OpenAsyncRead(*file);
+		}
+		delete cache->OpenAsyncRead(*(workDir / TEXT("MountConfig.ini")));
+		if (latency.GetNumAsyncOpens() - asyncOpens != CachedFiles + 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Mount benchmark: the cache layer does not forward OpenAsyncRead"));
+			bCacheChecked = false;
+		}
+
+		cache->stopFetches();
+		cache.Reset();
+		IFileManager::Get().DeleteDirectory(*cacheSettings.CacheDir, false, true);
+	}
+
+	// Steady state of writeMountSign, the dirs and buffers were all seen before the phase starts. Signs
+	// are written on every mount, an allocation here is a failure and not just a slower run.
+	bool bSignsChecked = true;
+	if (newRoots.Num() > 0 && bResolved)
+	{
+		const FString event = TEXT("Start Mount");
+		for (const FString& root : newRoots)
+		{
+			manager->writeMountSign(root, event, FDateTime::Now());
+		}
+		const MountBenchmarkPhase& phase = outPhases.Add_GetRef(measure(TEXT("WriteMountSign"), latency, [&]() {
+			for (int32 i = 0; i < SignEvents; ++i)
+			{
+				manager->writeMountSign(newRoots[i % newRoots.Num()], event, FDateTime::Now());
+			}
+		}));
+		if (phase.Allocations > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Mount benchmark: writeMountSign made %.2f heap allocations per event"), (double)phase.Allocations / SignEvents);
+			bSignsChecked = false;
+		}
+	}
+
+	FPlatformFileManager::Get().RemovePlatformFile(&latency);
+	manager->unregisterAllMountPoints();
+	auditStore.Close();
+	GConfig->UnloadFile(manager->mProjectConfigOverride);
+	GConfig->UnloadFile(manager->mPluginConfigOverride);
+
+	if (!bResolved)
+	{
+		// The probe still holds the manager, leave it to it and make its answer stale
+		++manager->mMountLogPathRequest;
+		manager->mAuditStore = nullptr;
+		manager.Release();
+		UE_LOG(LogTemp, Error, TEXT("Mount benchmark: log root was not resolved within %.0fs"), LogResolveTimeoutSeconds);
+		return false;
+	}
+	return bCacheChecked && bSignsChecked;
+}
+
+// Mount.Benchmark [Depth=3] [FanOut=4] [Packages=8] [Roots=16] [Added=8] [Rules=32] [LatencyMs=1] [Tolerance=0.1] [WorkDir=...] [SaveBaseline]
+static FAutoConsoleCommand GMountBenchmarkCommand(
+	TEXT("Mount.Benchmark"),
+	TEXT("Replay mounting a generated library tree with injected latency, write timings and allocations and compare with the baseline. ")
+	TEXT("Args: [Depth=3] [FanOut=4] [Packages=8] [Roots=16] [Added=8] [Rules=32] [LatencyMs=1] [Tolerance=0.1] [WorkDir=...] [SaveBaseline]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const FString cmd = FString::Join(Args, TEXT(" "));
+		MountBenchmarkSettings settings;
+		FParse::Value(*cmd, TEXT("Depth="), settings.Depth);
+		FParse::Value(*cmd, TEXT("FanOut="), settings.FanOut);
+		FParse::Value(*cmd, TEXT("Packages="), settings.PackagesPerFolder);
+		FParse::Value(*cmd, TEXT("Roots="), settings.NumRoots);
+		FParse::Value(*cmd, TEXT("Added="), settings.NumNewRoots);
+		FParse::Value(*cmd, TEXT("Rules="), settings.NumRules);
+		FParse::Value(*cmd, TEXT("LatencyMs="), settings.LatencyMs);
+		FParse::Value(*cmd, TEXT("Tolerance="), settings.Tolerance);
+		FParse::Value(*cmd, TEXT("WorkDir="), settings.WorkDir);
+		settings.bSaveBaseline = FParse::Param(*cmd, TEXT("SaveBaseline")) || Args.Contains(TEXT("SaveBaseline"));
+		settings.Depth = FMath::Max(settings.Depth, 1);
+		settings.FanOut = FMath::Max(settings.FanOut, 1);
+		MountBenchmark::Run(settings);
+	})
+);
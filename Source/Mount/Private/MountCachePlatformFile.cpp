@@ -0,0 +1,425 @@
+#include "MountCachePlatformFile.h"
+#include "Async/Async.h"
+#include "AtomicFile.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	const uint32 IndexMagic = 0x4D4E5452; // "MNTR"
+	const int32 IndexVersion = 1;
+	const int64 CopyChunkBytes = 1024 * 1024;
+
+	TUniquePtr<MountCachePlatformFile> GMountCache;
+
+	bool isPackageFile(const FString& path)
+	{
+		static const TCHAR* Extensions[] = { TEXT(".uasset"), TEXT(".umap"), TEXT(".uexp"), TEXT(".ubulk"), TEXT(".uptnl") };
+		for (const TCHAR* extension : Extensions)
+		{
+			if (path.EndsWith(extension)) return true;
+		}
+		return false;
+	}
+
+	FString hashFile(const FString& file)
+	{
+		return LexToString(FMD5Hash::HashFile(*file));
+	}
+}
+
+MountCachePlatformFile* MountCachePlatformFile::Install(const MountCacheSettings& settings)
+{
+	if (GMountCache) return GMountCache.Get();
+
+	GMountCache.Reset(new MountCachePlatformFile(settings));
+	IPlatformFile& current = FPlatformFileManager::Get().GetPlatformFile();
+	if (!GMountCache->Initialize(&current, TEXT("")))
+	{
+		GMountCache.Reset();
+		return nullptr;
+	}
+	GMountCache->loadIndex();
+	FPlatformFileManager::Get().SetPlatformFile(*GMountCache);
+
+	UE_LOG(LogTemp, Log, TEXT("Mount cache: %s, %d files, %.1f of %.1f MB"), *settings.CacheDir,
+		GMountCache->mEntries.Num(), GMountCache->mTotalSize / (1024.0 * 1024.0), settings.MaxSizeBytes / (1024.0 * 1024.0));
+	return GMountCache.Get();
+}
+
+void MountCachePlatformFile::Uninstall()
+{
+	if (!GMountCache) return;
+
+	GMountCache->stopFetches();
+	GMountCache->saveIndex();
+	GMountCache->LogStats();
+	FPlatformFileManager::Get().RemovePlatformFile(GMountCache.Get());
+	GMountCache.Reset();
+}
+
+MountCachePlatformFile* MountCachePlatformFile::Get()
+{
+	return GMountCache.Get();
+}
+
+MountCachePlatformFile::MountCachePlatformFile(const MountCacheSettings& settings)
+	: mSettings(settings)
+{
+	FPaths::NormalizeDirectoryName(mSettings.CacheDir);
+	for (FString& root : mSettings.Roots)
+	{
+		FPaths::NormalizeDirectoryName(root);
+		root = root.ToLower() + TEXT("/");
+	}
+	mIndexFile = mSettings.CacheDir / TEXT("MountCacheIndex.bin");
+}
+
+bool MountCachePlatformFile::isCachedPath(const FString& path) const
+{
+	if (!isPackageFile(path) || path.StartsWith(mSettings.CacheDir)) return false;
+
+	for (const FString& root : mSettings.Roots)
+	{
+		if (path.StartsWith(root)) return true;
+	}
+	for (const FString& word : mSettings.ReadonlyWords)
+	{
+		if (path.Contains(word)) return true;
+	}
+	return false;
+}
+
+FString MountCachePlatformFile::localPathFor(const FString& path) const
+{
+	// Same layout writeMountSign uses for its log tree: "//server/share/x" -> "server/share/x", "D:/x" -> "D/x"
+	FString relative = path;
+	if (relative.RemoveFromStart(TEXT("//")))
+	{
+		return mSettings.CacheDir / relative;
+	}
+	relative.ReplaceInline(TEXT(":/"), TEXT("/"));
+	return mSettings.CacheDir / relative;
+}
+
+bool MountCachePlatformFile::isCurrent(const Entry& entry, const FFileStatData& stat) const
+{
+	if (entry.Size != stat.FileSize) return false;
+	return mSettings.Validation == MountCacheValidation::Size || entry.ModificationTicks == stat.ModificationTime.GetTicks();
+}
+
+bool MountCachePlatformFile::findLocalCopy(const TCHAR* Filename, FString& outLocalFile)
+{
+	FString path(Filename);
+	FPaths::NormalizeFilename(path);
+	const FString key = path.ToLower();
+	if (!isCachedPath(key)) return false;
+
+	// One round-trip to the share to validate, instead of every read going over it
+	const FFileStatData stat = LowerLevel->GetStatData(Filename);
+	if (!stat.bIsValid || stat.bIsDirectory) return false;
+
+	FString localFile;
+	bool bNeedsVerify = false;
+	FString hash;
+	{
+		FScopeLock lock(&mLock);
+		Entry* entry = mEntries.Find(key);
+		if (entry && isCurrent(*entry, stat))
+		{
+			entry->LastAccessTicks = FDateTime::UtcNow().GetTicks();
+			localFile = entry->LocalFile;
+			bNeedsVerify = mSettings.Validation == MountCacheValidation::Hash && !entry->bVerified;
+			hash = entry->Hash;
+		}
+	}
+
+	if (!localFile.IsEmpty())
+	{
+		bool bValid = true;
+		if (bNeedsVerify)
+		{
+			bValid = hashFile(localFile) == hash;
+			FScopeLock lock(&mLock);
+			if (Entry* entry = mEntries.Find(key))
+			{
+				entry->bVerified = bValid;
+			}
+		}
+		if (bValid)
+		{
+			++mNumHits;
+			outLocalFile = localFile;
+			return true;
+		}
+	}
+
+	++mNumMisses;
+	scheduleFetch(path, key, stat);
+	return false;
+}
+
+IFileHandle* MountCachePlatformFile::OpenRead(const TCHAR* Filename, bool bAllowWrite)
+{
+	FString localFile;
+	if (!bAllowWrite && findLocalCopy(Filename, localFile))
+	{
+		if (IFileHandle* handle = LowerLevel->OpenRead(*localFile))
+		{
+			return handle;
+		}
+	}
+	return LowerLevel->OpenRead(Filename, bAllowWrite);
+}
+
+IAsyncReadFileHandle* MountCachePlatformFile::OpenAsyncRead(const TCHAR* Filename)
+{
+	// Async handles open lazily, a local copy that exists now is the one they get
+	FString localFile;
+	return LowerLevel->OpenAsyncRead(findLocalCopy(Filename, localFile) ? *localFile : Filename);
+}
+
+IMappedFileHandle* MountCachePlatformFile::OpenMapped(const TCHAR* Filename)
+{
+	FString localFile;
+	if (findLocalCopy(Filename, localFile))
+	{
+		if (IMappedFileHandle* handle = LowerLevel->OpenMapped(*localFile))
+		{
+			return handle;
+		}
+	}
+	return LowerLevel->OpenMapped(Filename);
+}
+
+void MountCachePlatformFile::scheduleFetch(const FString& path, const FString& key, const FFileStatData& stat)
+{
+	{
+		FScopeLock lock(&mLock);
+		if (bStopping) return;
+
+		bool bAlreadyFetching = false;
+		mFetching.Add(key, &bAlreadyFetching);
+		if (bAlreadyFetching) return;
+		++mNumFetchTasks;
+	}
+
+	// The loader reads this open from the share, the copy is for the next one
+	Async(EAsyncExecution::ThreadPool, [this, path, key, stat]() {
+		Entry fetched;
+		const bool bFetched = fetch(path, stat, fetched);
+
+		FScopeLock lock(&mLock);
+		if (bFetched)
+		{
+			if (Entry* old = mEntries.Find(key))
+			{
+				mTotalSize -= old->Size;
+			}
+			mTotalSize += fetched.Size;
+			mEntries.Add(key, MoveTemp(fetched));
+			evict();
+		}
+		mFetching.Remove(key);
+		--mNumFetchTasks;
+	});
+}
+
+void MountCachePlatformFile::waitForFetches()
+{
+	while (mNumFetchTasks.Load() > 0)
+	{
+		FPlatformProcess::Sleep(0.01f);
+	}
+}
+
+void MountCachePlatformFile::stopFetches()
+{
+	bStopping = true;
+	waitForFetches();
+}
+
+bool MountCachePlatformFile::fetch(const FString& path, const FFileStatData& stat, Entry& outEntry)
+{
+	const FString localFile = localPathFor(path);
+	// Unique temp name, a copy started after an invalidation may overlap an older one
+	const FString tempFile = localFile + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	LowerLevel->CreateDirectoryTree(*FPaths::GetPath(localFile));
+
+	// In chunks so shutting down does not wait for a whole package to come over the share
+	bool bCopied = false;
+	{
+		TUniquePtr<IFileHandle> source(LowerLevel->OpenRead(*path));
+		TUniquePtr<IFileHandle> dest(source ? LowerLevel->OpenWrite(*tempFile) : nullptr);
+		if (source && dest)
+		{
+			TArray<uint8> buffer;
+			buffer.SetNumUninitialized((int32)FMath::Clamp<int64>(stat.FileSize, 1, CopyChunkBytes));
+			int64 remaining = source->Size();
+			bCopied = remaining == stat.FileSize;
+			while (bCopied && remaining > 0)
+			{
+				const int64 chunk = FMath::Min<int64>(remaining, buffer.Num());
+				bCopied = !bStopping && source->Read(buffer.GetData(), chunk) && dest->Write(buffer.GetData(), chunk);
+				remaining -= chunk;
+			}
+			bCopied &= dest->Flush();
+		}
+	}
+	if (!bCopied)
+	{
+		LowerLevel->DeleteFile(*tempFile);
+		return false;
+	}
+
+	// A copy that is still open can't be replaced, the share keeps serving the file
+	if ((LowerLevel->FileExists(*localFile) && !LowerLevel->DeleteFile(*localFile)) || !LowerLevel->MoveFile(*localFile, *tempFile))
+	{
+		LowerLevel->DeleteFile(*tempFile);
+		return false;
+	}
+
+	outEntry.LocalFile = localFile;
+	outEntry.Size = stat.FileSize;
+	outEntry.ModificationTicks = stat.ModificationTime.GetTicks();
+	outEntry.LastAccessTicks = FDateTime::UtcNow().GetTicks();
+	if (mSettings.Validation == MountCacheValidation::Hash)
+	{
+		outEntry.Hash = hashFile(localFile);
+		outEntry.bVerified = true;
+	}
+	mBytesFetched += stat.FileSize;
+	return true;
+}
+
+void MountCachePlatformFile::evict()
+{
+	if (mTotalSize <= mSettings.MaxSizeBytes) return;
+
+	// Down to 90% so the sort is not repeated for every fetch once the cache is full
+	const int64 target = mSettings.MaxSizeBytes / 10 * 9;
+	TArray<TPair<int64, FString>> byAccess;
+	byAccess.Reserve(mEntries.Num());
+	for (const TPair<FString, Entry>& pair : mEntries)
+	{
+		byAccess.Emplace(pair.Value.LastAccessTicks, pair.Key);
+	}
+	byAccess.Sort([](const TPair<int64, FString>& a, const TPair<int64, FString>& b) { return a.Key < b.Key; });
+
+	for (const TPair<int64, FString>& oldest : byAccess)
+	{
+		if (mTotalSize <= target) break;
+
+		const Entry& entry = mEntries[oldest.Value];
+		// Still open by a loader, try again on the next eviction
+		if (LowerLevel->FileExists(*entry.LocalFile) && !LowerLevel->DeleteFile(*entry.LocalFile)) continue;
+
+		mTotalSize -= entry.Size;
+		mEntries.Remove(oldest.Value);
+		++mNumEvicted;
+	}
+}
+
+void MountCachePlatformFile::invalidate(const TCHAR* Filename)
+{
+	FString path(Filename);
+	FPaths::NormalizeFilename(path);
+	const FString key = path.ToLower();
+	if (!isCachedPath(key)) return;
+
+	FScopeLock lock(&mLock);
+	Entry removed;
+	if (mEntries.RemoveAndCopyValue(key, removed))
+	{
+		mTotalSize -= removed.Size;
+		LowerLevel->DeleteFile(*removed.LocalFile);
+	}
+}
+
+IFileHandle* MountCachePlatformFile::OpenWrite(const TCHAR* Filename, bool bAppend, bool bAllowRead)
+{
+	invalidate(Filename);
+	return LowerLevel->OpenWrite(Filename, bAppend, bAllowRead);
+}
+
+bool MountCachePlatformFile::DeleteFile(const TCHAR* Filename)
+{
+	invalidate(Filename);
+	return LowerLevel->DeleteFile(Filename);
+}
+
+bool MountCachePlatformFile::MoveFile(const TCHAR* To, const TCHAR* From)
+{
+	invalidate(To);
+	invalidate(From);
+	return LowerLevel->MoveFile(To, From);
+}
+
+void MountCachePlatformFile::loadIndex()
+{
+	TArray<uint8> bytes;
+	if (!FFileHelper::LoadFileToArray(bytes, *mIndexFile, FILEREAD_Silent)) return;
+
+	FMemoryReader reader(bytes);
+	uint32 magic = 0;
+	int32 version = 0;
+	reader << magic << version;
+	if (magic != IndexMagic || version != IndexVersion) return;
+
+	TMap<FString, Entry> entries;
+	reader << entries;
+	if (reader.IsError()) return;
+
+	FScopeLock lock(&mLock);
+	mEntries = MoveTemp(entries);
+	mTotalSize = 0;
+	for (const TPair<FString, Entry>& pair : mEntries)
+	{
+		mTotalSize += pair.Value.Size;
+	}
+}
+
+void MountCachePlatformFile::saveIndex()
+{
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	uint32 magic = IndexMagic;
+	int32 version = IndexVersion;
+	writer << magic << version;
+	{
+		FScopeLock lock(&mLock);
+		writer << mEntries;
+	}
+
+	AtomicFile::SaveArrayToFile(bytes, mIndexFile);
+}
+
+void MountCachePlatformFile::LogStats() const
+{
+	FScopeLock lock(&mLock);
+	const int32 hits = mNumHits.Load();
+	const int32 misses = mNumMisses.Load();
+	UE_LOG(LogTemp, Log, TEXT("Mount cache: %d hits, %d misses (%.1f%% hit), %.1f MB fetched, %d evicted, %d files %.1f MB cached"),
+		hits, misses, hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0, mBytesFetched.Load() / (1024.0 * 1024.0),
+		mNumEvicted.Load(), mEntries.Num(), mTotalSize / (1024.0 * 1024.0));
+}
+
+static FAutoConsoleCommand GMountCacheStatsCommand(
+	TEXT("Mount.Cache.Stats"),
+	TEXT("Log hit rate and size of the local mount cache"),
+	FConsoleCommandDelegate::CreateLambda([]() {
+		if (MountCachePlatformFile* cache = MountCachePlatformFile::Get())
+		{
+			cache->LogStats();
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Mount cache is disabled, see [MountCache] in MountPluginConfig.ini"));
+		}
+	})
+);
@@ -0,0 +1,155 @@
+#include "MountConfigSnapshot.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+const uint32 MountConfigSnapshot::Magic = 0x4D4E5443; // "MNTC"
+const int32 MountConfigSnapshot::Version = 6;
+
+FString MountConfigSnapshot::GetSnapshotPath(const FString& iniPath)
+{
+	// Not next to the ini, the plugin folder is replaced by updates. One per ini, the benchmark's has the same name.
+	const uint32 pathHash = FCrc::StrCrc32(*FPaths::ConvertRelativePathToFull(iniPath));
+	return FPaths::ProjectSavedDir() / TEXT("Mount") / FString::Printf(TEXT("%s-%08X.bin"), *FPaths::GetBaseFilename(iniPath), pathHash);
+}
+
+void MountConfigSnapshot::Load(const FString& iniPath)
+{
+	TArray<uint8> iniBytes;
+	FFileHelper::LoadFileToArray(iniBytes, *iniPath, FILEREAD_Silent);
+	FMD5 md5;
+	md5.Update(iniBytes.GetData(), iniBytes.Num());
+	FMD5Hash hash;
+	hash.Set(md5);
+	const FString iniHash = LexToString(hash);
+
+	const FString snapshotPath = GetSnapshotPath(iniPath);
+	if (loadSnapshot(snapshotPath, iniHash))
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Mount config snapshot out of date, parsing %s"), *iniPath);
+	*this = MountConfigSnapshot();
+	IniHash = iniHash;
+	parseIni(iniPath);
+	saveSnapshot(snapshotPath);
+}
+
+bool MountConfigSnapshot::loadSnapshot(const FString& snapshotPath, const FString& iniHash)
+{
+	TArray<uint8> bytes;
+	if (!FFileHelper::LoadFileToArray(bytes, *snapshotPath, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader reader(bytes);
+	uint32 magic = 0;
+	int32 version = 0;
+	reader << magic << version;
+	if (magic != Magic || version != Version)
+	{
+		return false;
+	}
+
+	reader << IniHash;
+	if (IniHash != iniHash)
+	{
+		return false;
+	}
+
+	serialize(reader);
+	return !reader.IsError();
+}
+
+void MountConfigSnapshot::saveSnapshot(const FString& snapshotPath)
+{
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	uint32 magic = Magic;
+	int32 version = Version;
+	writer << magic << version << IniHash;
+	serialize(writer);
+
+	// A stale or missing snapshot only costs a reparse, so failing to write is not an error
+	FFileHelper::SaveArrayToFile(bytes, *snapshotPath);
+}
+
+void MountConfigSnapshot::serialize(FArchive& Ar)
+{
+	Ar << Rules;
+	Ar << ReadonlyMountPaths;
+	Ar << MountLogRootPaths;
+	Ar << MountNeedLogDirs;
+	Ar << OptionalDirs;
+	Ar << MustMountDirs;
+	Ar << bLegacyTextLog;
+	Ar << bCacheEnabled << CacheDir << CacheMaxSizeMB << CacheValidation << CacheRoots;
+	Ar << bWarmupEnabled << WarmupMaxConcurrency << WarmupMaxMBPerSecond << WarmupHeaderKB;
+	Ar << bUpdateEnabled << UpdateSource << UpdateCheckDelaySeconds;
+	Ar << CollisionPolicy;
+}
+
+void MountConfigSnapshot::parseIni(const FString& iniPath)
+{
+	// Mount rules
+	TArray<FString> values;
+	if (GConfig->GetArray(TEXT("MountRule"), TEXT("Rule"), values, *iniPath)) {
+		for (const FString& value : values) {
+			FString entry = value;
+			entry.RemoveFromStart(TEXT("("));
+			entry.RemoveFromEnd(TEXT(")"));
+
+			MountRule rule;
+			if (FParse::Value(*entry, TEXT("SubDir="), rule.SubDir)) {
+				rule.Entry = entry;
+				FString requiredFolders;
+				if (FParse::Value(*entry, TEXT("Requires="), requiredFolders)) {
+					requiredFolders.ParseIntoArray(rule.Requires, TEXT(","));
+				}
+				Rules.Add(rule);
+			}
+		}
+	}
+
+	GConfig->GetArray(TEXT("ReadonlyMountPath"), TEXT("Path"), ReadonlyMountPaths, *iniPath);
+	GConfig->GetArray(TEXT("MountLogRootPath"), TEXT("Path"), MountLogRootPaths, *iniPath);
+	GConfig->GetArray(TEXT("MountNeedLogDir"), TEXT("Path"), MountNeedLogDirs, *iniPath);
+
+	// Optional asset folder
+	FKeyValueSink visitor;
+	visitor.BindLambda([this](const TCHAR* Key, const TCHAR* Value) {
+		OptionalDirs.Add(Key, Value);
+	});
+	GConfig->ForEachEntry(visitor, TEXT("OptionalMountList"), *iniPath);
+
+	// must mount dirs
+	FKeyValueSink mustMountVisitor;
+	mustMountVisitor.BindLambda([this](const TCHAR* Key, const TCHAR* Value) {
+		MustMountDirs.Add(Key, Value);
+	});
+	GConfig->ForEachEntry(mustMountVisitor, TEXT("Server"), *iniPath);
+
+	GConfig->GetBool(TEXT("MountAudit"), TEXT("LegacyTextLog"), bLegacyTextLog, *iniPath);
+
+	GConfig->GetBool(TEXT("MountCache"), TEXT("Enabled"), bCacheEnabled, *iniPath);
+	GConfig->GetString(TEXT("MountCache"), TEXT("CacheDir"), CacheDir, *iniPath);
+	GConfig->GetInt(TEXT("MountCache"), TEXT("MaxSizeMB"), CacheMaxSizeMB, *iniPath);
+	GConfig->GetString(TEXT("MountCache"), TEXT("Validation"), CacheValidation, *iniPath);
+	GConfig->GetArray(TEXT("MountCache"), TEXT("Root"), CacheRoots, *iniPath);
+
+	GConfig->GetBool(TEXT("MountWarmup"), TEXT("Enabled"), bWarmupEnabled, *iniPath);
+	GConfig->GetInt(TEXT("MountWarmup"), TEXT("MaxConcurrency"), WarmupMaxConcurrency, *iniPath);
+	GConfig->GetInt(TEXT("MountWarmup"), TEXT("MaxMBPerSecond"), WarmupMaxMBPerSecond, *iniPath);
+	GConfig->GetInt(TEXT("MountWarmup"), TEXT("HeaderKB"), WarmupHeaderKB, *iniPath);
+
+	GConfig->GetBool(TEXT("PluginUpdate"), TEXT("Enabled"), bUpdateEnabled, *iniPath);
+	GConfig->GetString(TEXT("PluginUpdate"), TEXT("Source"), UpdateSource, *iniPath);
+	GConfig->GetFloat(TEXT("PluginUpdate"), TEXT("CheckDelaySeconds"), UpdateCheckDelaySeconds, *iniPath);
+
+	GConfig->GetString(TEXT("MountCollision"), TEXT("Policy"), CollisionPolicy, *iniPath);
+}
@@ -19,6 +19,22 @@
 #include "AssetTools/Private/SDiscoveringAssetsDialog.h"
 #include "Runtime/Sockets/Public/SocketSubsystem.h"
 #include "IPAddress.h"
+#include "SMountedDirList.h"
+#include "MountAuditStore.h"
+#include "MountSignFormatter.h"
+#include "DirectoryWalker.h"
+#include "MountCachePlatformFile.h"
+#include "MountWarmup.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "PackageImportReader.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
+#include "Misc/CoreDelegates.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
 
 #define LOCTEXT_NAMESPACE "FMountModule"
 MountManager::MountManager()
@@ -29,10 +45,8 @@ MountManager::~MountManager()
 }
 MountManager& MountManager::Get()
 {
-	static TUniquePtr<MountManager> Singleton;
-	if (!Singleton) {
-		Singleton = MakeUnique<MountManager>();
-	}
+	// Function statics are initialized once even when background tools race for the first call
+	static TUniquePtr<MountManager> Singleton = MakeUnique<MountManager>();
 	return *Singleton;
 }
 
@@ -44,25 +58,73 @@ void MountManager::Init(const FString& pluginPath)
 		FExecuteAction::CreateRaw(this, &MountManager::onMountButtonClick)
 	);
 
+	initMounts();
+
+	// Get make readonly exe
+	mMakeReadonlyEXEPath = FPaths::Combine(pluginPath, TEXT("cmd_MakeFolderReadonly.exe"));
+}
+
+void MountManager::initMounts()
+{
+	mGameMountPointId = mPathTable.Intern(mMountPoint);
+	mPointRegistry.Init(&mPathTable, mGameMountPointId);
 	loadMountConfigs();
+	{
+		// Project folders hold their /Game/ points before any mount can shadow them
+		DirectoryWalker walker;
+		mPointRegistry.AddProjectFolders(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()), walker);
+	}
 
 	// choose mount method
-	FString iniPath = Utilities::Get().GetProjectConfigPath();
+	FString iniPath = getProjectConfigPath();
 	TArray<FString> levelMountStrs;
 	GConfig->GetArray(*mAssetSection, TEXT("MountedPaths"), levelMountStrs, *iniPath);
 	mByMethod = levelMountStrs.Num() > 0 ? MountMethod::ByLevelConfig : MountMethod::ByDirectory;
 
 	// Mount folder from project ini file
 	mountIniFile(iniPath, mByMethod);
+}
 
-	// Get make readonly exe
-	mMakeReadonlyEXEPath = FPaths::Combine(pluginPath, TEXT("cmd_MakeFolderReadonly.exe"));
+FString MountManager::getProjectConfigPath() const
+{
+	return mProjectConfigOverride.IsEmpty() ? Utilities::Get().GetProjectConfigPath() : mProjectConfigOverride;
+}
+
+FString MountManager::getPluginConfigPath() const
+{
+	return mPluginConfigOverride.IsEmpty() ? Utilities::Get().GetPluginConfigPath() : mPluginConfigOverride;
+}
+
+MountAuditStore& MountManager::auditStore()
+{
+	return mAuditStore ? *mAuditStore : MountAuditStore::Get();
+}
+
+void MountManager::unregisterAllMountPoints()
+{
+	TArray<TPair<MountPathId, MountPathId>> points;
+	for (const TPair<MountPathId, MountPathId>& pair : mMountPoints) {
+		points.Emplace(pair.Key, pair.Value);
+	}
+	for (const TPair<MountPathId, MountPathId>& point : points) {
+		RemoveMountPoint(point.Key, point.Value);
+	}
+	publishMountState();
 }
 
 void MountManager::Shutdown()
 {
+	if (mMountScheduler.IsValid())
+	{
+		mMountScheduler->Cancel();
+		mMountScheduler.Reset();
+	}
+	// Warm-up reads go to the layer below the cache, stop them before the cache leaves the chain
+	MountWarmup::Get().Shutdown();
+	MountCachePlatformFile::Uninstall();
+
 	TArray<FString> paths;
-	FString iniPath = Utilities::Get().GetProjectConfigPath();
+	FString iniPath = getProjectConfigPath();
 	
 	switch (mByMethod)
 	{
@@ -86,6 +148,13 @@ void MountManager::Shutdown()
 		}
 		break;
 	}
+
+	// A probe finishing after this would open the audit store again once it is closed
+	++mMountLogPathRequest;
+	if (!bMountLogPathResolved) {
+		savePendingMountSigns();
+	}
+	mPendingMountSigns.Empty();
 }
 
 // Generate menus...
@@ -99,22 +168,67 @@ void MountManager::GenMenu(FMenuBuilder& MenuBuilder)
 			FNewMenuDelegate::CreateRaw(this, &MountManager::createUnmountSubMenu)
 		);
 	}
+
+	// Profile menu
+	if (GetMountProfileNames().Num() > 0) {
+		MenuBuilder.AddSubMenu(
+			LOCTEXT("MountProfiles", "Profiles"),
+			LOCTEXT("MountProfilesTip", "Switch to a saved set of mounted folders"),
+			FNewMenuDelegate::CreateRaw(this, &MountManager::createProfileSubMenu)
+		);
+	}
 }
 
-void MountManager::createUnmountSubMenu(FMenuBuilder& MenuBuilder)
+void MountManager::createProfileSubMenu(FMenuBuilder& MenuBuilder)
 {
-	int32 num = mMountedDatas.Num();
-	//FString prefix = LOCTEXT("Unmount", "Unmount").ToString();
-	for (int32 i = 0; i < num; ++i) {
+	FString activeProfile;
+	GConfig->GetString(*mSectionName, TEXT("ActiveProfile"), activeProfile, getProjectConfigPath());
+	for (const FString& name : GetMountProfileNames()) {
 		MenuBuilder.AddMenuEntry(
-			FText::FromString(FString::Printf(TEXT("%s"), *mMountedDatas[i].RootDir)),
-			FText::FromString(TEXT("")),
+			FText::FromString(name),
+			FText::Format(LOCTEXT("SwitchProfileTip", "Mount the folders of profile {0}"), FText::FromString(name)),
 			FSlateIcon(),
-			FUIAction(FExecuteAction::CreateRaw(this, &MountManager::onUnmountButtonClick, mMountedDatas[i]))
+			FUIAction(
+				FExecuteAction::CreateLambda([this, name]() { SwitchMountProfile(name); }),
+				FCanExecuteAction(),
+				FIsActionChecked::CreateLambda([name, activeProfile]() { return name.Equals(activeProfile); })
+			),
+			NAME_None,
+			EUserInterfaceActionType::RadioButton
 		);
 	}
 }
 
+void MountManager::createUnmountSubMenu(FMenuBuilder& MenuBuilder)
+{
+	// One virtualized list instead of an entry per mounted root
+	MenuBuilder.AddWidget(
+		SNew(SMountedDirList)
+		.Items(getMountedItems())
+		.OnItemClicked_Lambda([this](const MountData& data) {
+			onUnmountButtonClick(data);
+		}),
+		FText::GetEmpty(),
+		true
+	);
+}
+
+TSharedPtr<const TArray<TSharedPtr<MountData>>> MountManager::getMountedItems()
+{
+	if (!mMountedItems.IsValid() || mMountedItemsRevision != mMountedDatasRevision)
+	{
+		TSharedPtr<TArray<TSharedPtr<MountData>>> items = MakeShared<TArray<TSharedPtr<MountData>>>();
+		items->Reserve(mMountedDatas.Num());
+		for (const MountData& data : mMountedDatas)
+		{
+			items->Add(MakeShared<MountData>(data));
+		}
+		mMountedItems = items;
+		mMountedItemsRevision = mMountedDatasRevision;
+	}
+	return mMountedItems;
+}
+
 // Button callback
 void MountManager::onMountButtonClick()
 {
@@ -141,6 +255,7 @@ void MountManager::onUnmountButtonClick(MountData unmountData)
 {
 	UE_LOG(LogTemp, Log, TEXT("unmount : %s"), *unmountData.RootDir);
 	removeMountedData(unmountData);
+	publishMountState();
 
 	writeMountSign(unmountData.RootDir, TEXT("Remove Mount Point"));
 }
@@ -151,18 +266,200 @@ void MountManager::onMountRecommendedAsset(FString dir)
 }
 
 // Aux...
+namespace
+{
+	// Packages of the maps the editor may open at startup
+	TArray<FString> getStartupMaps()
+	{
+		TArray<FString> maps;
+		FString map;
+		if (GConfig->GetString(TEXT("EditorStartup"), TEXT("LastLevel"), map, GEditorPerProjectIni)) maps.Add(map);
+		if (GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("EditorStartupMap"), map, GEngineIni)) maps.Add(map);
+		const TCHAR* cmdLine = FCommandLine::Get();
+		FString token;
+		while (FParse::Token(cmdLine, token, false)) {
+			if (token.StartsWith(TEXT("/Game/"))) maps.Add(token);
+		}
+
+		TArray<FString> packages;
+		for (const FString& path : maps) {
+			// "/Game/Maps/Start.Start" in the settings
+			if (path.StartsWith(TEXT("/Game/"))) packages.AddUnique(FPackageName::ObjectPathToPackageName(path));
+		}
+		return packages;
+	}
+
+	// "/Game/A/B/" -> "A"
+	FString getTopGameFolder(const FString& point)
+	{
+		FString path = point;
+		path.RemoveFromStart(TEXT("/Game/"));
+		FString folder, rest;
+		return path.Split(TEXT("/"), &folder, &rest) ? folder : path;
+	}
+
+	// Past this the walk costs more than mounting everything up front
+	const int32 MaxStartupPackages = 4096;
+
+	enum class PackageRead : uint8
+	{
+		Missing,
+		Read,
+		Failed,
+	};
+
+	// Hard imports, and for maps soft references too: streaming sublevels are soft, the editor opens
+	// them with the persistent level
+	PackageRead readPackageImports(const FString& fileBase, TArray<FName>& outImports)
+	{
+		const FString mapFile = fileBase + FPackageName::GetMapPackageExtension();
+		if (IFileManager::Get().FileSize(*mapFile) >= 0) {
+			return PackageImportReader::ReadImportedPackages(mapFile, outImports, &outImports) ? PackageRead::Read : PackageRead::Failed;
+		}
+		const FString assetFile = fileBase + FPackageName::GetAssetPackageExtension();
+		if (IFileManager::Get().FileSize(*assetFile) >= 0) {
+			return PackageImportReader::ReadImportedPackages(assetFile, outImports) ? PackageRead::Read : PackageRead::Failed;
+		}
+		return PackageRead::Missing;
+	}
+
+	// Plans providing the startup maps, their sublevels and every /Game package those import, directly
+	// or not, found by reading package headers before anything is mounted. False if that could not be
+	// worked out.
+	bool findStartupPlans(const TArray<MountPlan>& plans, TSet<int32>& outPlans, int32& outNumPackages)
+	{
+		// Mount point without its trailing '/' - plan and folder
+		TMap<FString, TPair<int32, FString>> points;
+		for (int32 i = 0; i < plans.Num(); ++i) {
+			for (const TPair<FString, FString>& point : plans[i].Points) {
+				FString key = point.Key;
+				key.RemoveFromEnd(TEXT("/"));
+				points.Add(key, TPair<int32, FString>(i, point.Value));
+			}
+		}
+		const FString projectContentDir = FPaths::ProjectContentDir();
+		const int32 gameLen = FCString::Strlen(TEXT("/Game"));
+
+		TArray<FString> level = getStartupMaps();
+		TSet<FString> visited(level);
+		bool bMaps = true;
+		while (level.Num() > 0) {
+			// File of each package, under the longest mount point it falls in or in the project
+			TArray<FString> fileBases;
+			fileBases.SetNum(level.Num());
+			for (int32 i = 0; i < level.Num(); ++i) {
+				const FString& package = level[i];
+				FString prefix = package;
+				int32 slash = INDEX_NONE;
+				while (prefix.FindLastChar(TEXT('/'), slash) && slash > gameLen) {
+					prefix.LeftInline(slash, false);
+					if (const TPair<int32, FString>* provider = points.Find(prefix)) {
+						outPlans.Add(provider->Key);
+						fileBases[i] = provider->Value / package.RightChop(prefix.Len() + 1);
+						break;
+					}
+				}
+				if (fileBases[i].IsEmpty()) fileBases[i] = projectContentDir / package.RightChop(gameLen + 1);
+			}
+
+			// Headers on a share are a round trip each, a level at a time in parallel
+			TArray<TArray<FName>> imports;
+			imports.SetNum(level.Num());
+			TArray<PackageRead> results;
+			results.SetNum(level.Num());
+			ParallelFor(level.Num(), [&](int32 i) {
+				results[i] = readPackageImports(fileBases[i], imports[i]);
+			});
+
+			TArray<FString> next;
+			for (int32 i = 0; i < level.Num(); ++i) {
+				// A dependency missing everywhere is missing at load time too, an unreadable map is not
+				if (results[i] == PackageRead::Failed || (bMaps && results[i] == PackageRead::Missing)) {
+					UE_LOG(LogTemp, Warning, TEXT("Startup mounts: cannot read the imports of %s"), *level[i]);
+					return false;
+				}
+				for (const FName& import : imports[i]) {
+					const FString name = import.ToString();
+					if (!name.StartsWith(TEXT("/Game/"))) continue;
+
+					bool bVisited = false;
+					visited.Add(name, &bVisited);
+					if (!bVisited) next.Add(name);
+				}
+			}
+			if (visited.Num() > MaxStartupPackages) {
+				UE_LOG(LogTemp, Warning, TEXT("Startup mounts: the startup maps import more than %d packages"), MaxStartupPackages);
+				return false;
+			}
+			level = MoveTemp(next);
+			bMaps = false;
+		}
+		outNumPackages = visited.Num();
+		return true;
+	}
+}
+
 void MountManager::mountIniFile(const FString& iniPath, MountMethod by)
 {
-	TArray<FString> Paths;
 	switch (by) {
 	case MountMethod::ByLevelConfig:
 		break;
 	case MountMethod::ByDirectory:
 	default:
 		getMountedData(mMountedDatas);
-		GConfig->GetArray(*mSectionName, TEXT("MountedDirs"), Paths, *iniPath);
-		for (FString path : Paths) {
-			registerMountPoint(MountData(path).RootDir);
+		++mMountedDatasRevision;
+		{
+			// Clashes are decided here in config order, not by whichever root the scheduler mounts first
+			TMap<MountPathId, MountPathId> resolved;
+			TArray<MountCollision> collisions;
+			validateMountDatas(mMountedDatas, true, resolved, collisions);
+			mPointRegistry.SetReserved(MoveTemp(resolved));
+			reportCollisions(collisions, true);
+		}
+		{
+			// Roots the startup map and its imports come from mount before the editor opens, the rest in the background
+			TArray<MountPlan> plans;
+			plans.SetNum(mMountedDatas.Num());
+			DirectoryWalker walker;
+			for (int32 i = 0; i < mMountedDatas.Num(); ++i) {
+				planMountPoint(mMountedDatas[i].RootDir, plans[i], walker, &mMountedDatas[i].SubDirs);
+			}
+			TSet<int32> startupPlans;
+			int32 numPackages = 0;
+			// The editor's startup map has nothing to do with an isolated manager's roots, it is told which mount first
+			if (bIsolated) {
+				for (int32 i = 0; i < plans.Num(); ++i) {
+					if (mIsolatedStartupRoots.Contains(plans[i].Root)) startupPlans.Add(i);
+				}
+			}
+			const bool bStartupKnown = bIsolated || findStartupPlans(plans, startupPlans, numPackages);
+			if (bStartupKnown) {
+				UE_LOG(LogTemp, Log, TEXT("Startup mounts: %d of %d roots provide the %d packages of the startup maps"), startupPlans.Num(), plans.Num(), numPackages);
+			}
+			else {
+				UE_LOG(LogTemp, Warning, TEXT("Startup mounts: startup map imports unknown, mounting all %d roots now"), plans.Num());
+			}
+
+			TArray<MountScheduler::Entry> deferred;
+			for (int32 i = 0; i < plans.Num(); ++i) {
+				if (!bStartupKnown || startupPlans.Contains(i)) {
+					registerMountPoint(plans[i].Root);
+					continue;
+				}
+
+				MountScheduler::Entry entry;
+				entry.Root = plans[i].Root;
+				// An isolated manager's roots are not the editor's, nothing to list or match
+				for (const TPair<FString, FString>& point : plans[i].Points) {
+					if (!bIsolated) entry.Folders.AddUnique(getTopGameFolder(point.Key));
+				}
+				deferred.Add(MoveTemp(entry));
+			}
+
+			if (mMountScheduler.IsValid()) mMountScheduler->Cancel();
+			mMountScheduler = MountScheduler::Start(deferred, [this](const FString& root) {
+				registerMountPoint(root);
+			});
 		}
 		break;
 	}
@@ -170,44 +467,39 @@ void MountManager::mountIniFile(const FString& iniPath, MountMethod by)
 
 void MountManager::registerMountPoint(const FString& path, bool isNewAdd /* = false */)
 {
-	MountData data;
-	data.RootDir = FString(path);
 	if (isNewAdd) writeMountSign(path, TEXT("Add Mount Point"));
 
 	readonlyFolder(path);
-	bool bInConfig = false;
-	for (const TPair<FString, FString> pair : mMountRules) {
-		if (path.Contains(pair.Key)) {
+	MountPlan plan;
+	DirectoryWalker walker;
+	planMountPoint(path, plan, walker);
+	TArray<MountCollision> collisions;
+	validateMountPlan(plan, collisions);
+	reportCollisions(collisions, isNewAdd);
+	applyMountPlan(plan, isNewAdd);
+	UE_LOG(LogTemp, Log, TEXT("mount:%s took %d filesystem calls"), *path, walker.GetNumCalls());
+}
+
+void MountManager::planMountPoint(const FString& path, MountPlan& outPlan, DirectoryWalker& walker, const TArray<FString>* recordedSubDirs /* = nullptr */) const
+{
+	outPlan.Root = path;
+	for (const MountRule& rule : mMountRules) {
+		if (path.Contains(rule.SubDir)) {
 			FString left, right;
-			if (path.Split(pair.Key, &left, &right, ESearchCase::IgnoreCase, ESearchDir::FromEnd)) {
+			if (path.Split(rule.SubDir, &left, &right, ESearchCase::IgnoreCase, ESearchDir::FromEnd)) {
 				// Mount incoming path
 				right.RemoveFromStart(TEXT("/"));
-				FString mountPoint = FPaths::Combine(mMountPoint, right);
-				AddMountPoint(mountPoint, path);
-				UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *mountPoint, *path);
-				if (isNewAdd) data.SubDirs.Add(path);
-				writeMountSign(path, TEXT("Start Mount"));
+				outPlan.Points.Emplace(FPaths::Combine(mMountPoint, right), path);
+				outPlan.SubDirs.Add(path);
+				outPlan.SignDirs.Add(path);
 
 				// Mount required path
-				FString requiredFolders;
-				if (FParse::Value(*pair.Value, TEXT("Requires="), requiredFolders)) {
-					FString requireStart = FPaths::Combine(left, pair.Key);
-					TArray<FString> pathArr;
-					requiredFolders.ParseIntoArray(pathArr, TEXT(","));
-
-					for (FString requireFolder : pathArr) {
-						mountPoint = FPaths::Combine(mMountPoint, requireFolder);
-						FString requirePath = FPaths::Combine(requireStart, requireFolder);
-						AddMountPoint(mountPoint, requirePath);
-						UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *mountPoint, *requirePath);
-						if (isNewAdd)
-						{
-							MountData requireData(requirePath, requirePath);
-							addMountedData(requireData);
-						}
-
-						writeMountSign(requireFolder, TEXT("Start Mount"));
-					}
+				FString requireStart = FPaths::Combine(left, rule.SubDir);
+				for (const FString& requireFolder : rule.Requires) {
+					FString requirePath = FPaths::Combine(requireStart, requireFolder);
+					outPlan.Points.Emplace(FPaths::Combine(mMountPoint, requireFolder), requirePath);
+					outPlan.RequiredDirs.Add(requirePath);
+					outPlan.SignDirs.Add(requireFolder);
 				}
 
 				// Search config file to mount
@@ -218,50 +510,73 @@ void MountManager::registerMountPoint(const FString& path, bool isNewAdd /* = fa
 						mountIniFile(configFile);
 					}
 				}*/
-
-				bInConfig = true;
-				break;
+				return;
 			}
 		}
 	}
 
-	if (!bInConfig) {
-		if (FPaths::GetBaseFilename(path).Equals(TEXT("Content"))) {
-			// Mount subfolder of Content
-			// Warning: Do not mount "/Game/", or you will not save assets to your disk.
-			TArray<FString> files;
-			IFileManager::Get().FindFiles(files, *(path + TEXT("/*")), false, true);
-			FString absPath;
-			for (FString file : files) {
-				absPath = FPaths::Combine(path, file);
-				if (FPaths::DirectoryExists(absPath)) {
-					AddMountPoint(mMountPoint / file, absPath);
-					UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *(mMountPoint / file), *absPath);
-					if (isNewAdd) data.SubDirs.Add(absPath);
-				}
+	if (FPaths::GetBaseFilename(path).Equals(TEXT("Content")) && recordedSubDirs) {
+		for (const FString& subDir : *recordedSubDirs) {
+			outPlan.Points.Emplace(mMountPoint / FPaths::GetCleanFilename(subDir), subDir);
+			outPlan.SubDirs.Add(subDir);
+		}
+	}
+	else if (FPaths::GetBaseFilename(path).Equals(TEXT("Content"))) {
+		// Mount subfolder of Content
+		// Warning: Do not mount "/Game/", or you will not save assets to your disk.
+		// The listing already says which entries are folders, no stat per entry
+		TArray<DirectoryEntry> entries;
+		walker.List(path, entries);
+		for (const DirectoryEntry& entry : entries) {
+			if (entry.bIsDirectory) {
+				outPlan.Points.Emplace(mMountPoint / entry.GetName(), entry.Path);
+				outPlan.SubDirs.Add(entry.Path);
 			}
 		}
-		else
-		{
-			// Mount to external folder
-			FString shortPath = FPaths::Combine(TEXT("/Game/"), FPaths::GetBaseFilename(path));
-			AddMountPoint(shortPath, path);
-			UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *shortPath, *path);
-			if (isNewAdd) data.SubDirs.Add(path);
+	}
+	else
+	{
+		// Mount to external folder
+		outPlan.Points.Emplace(FPaths::Combine(TEXT("/Game/"), FPaths::GetBaseFilename(path)), path);
+		outPlan.SubDirs.Add(path);
+	}
+	outPlan.SignDirs.Add(path);
+}
+
+void MountManager::applyMountPlan(const MountPlan& plan, bool isNewAdd)
+{
+	// Registering hands the folders to the registry's gatherer, the warm-up has to be on its way first
+	if (!bIsolated) MountWarmup::Get().Enqueue(plan.Points);
+	for (const TPair<FString, FString>& point : plan.Points) {
+		AddMountPoint(point.Key, point.Value);
+		UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *point.Key, *point.Value);
+	}
+
+	if (isNewAdd) {
+		for (const FString& requirePath : plan.RequiredDirs) {
+			addMountedData(MountData(requirePath, requirePath));
 		}
-		writeMountSign(path, TEXT("Start Mount"));
 	}
 
-	if (data.SubDirs.Num() > 0)
+	for (const FString& dir : plan.SignDirs) {
+		writeMountSign(dir, TEXT("Start Mount"));
+	}
+
+	if (isNewAdd && plan.SubDirs.Num() > 0)
 	{
+		MountData data;
+		data.RootDir = plan.Root;
+		data.SubDirs = plan.SubDirs;
 		addMountedData(data);
 	}
+
+	publishMountState();
 }
 
 void MountManager::getMountedData(TArray<MountData>& datas)
 {
 	TArray<FString> dataStrings;
-	GConfig->GetArray(*mSectionName, TEXT("MountedDirs"), dataStrings, Utilities::Get().GetProjectConfigPath());
+	GConfig->GetArray(*mSectionName, TEXT("MountedDirs"), dataStrings, getProjectConfigPath());
 	for (FString str : dataStrings)
 	{
 		datas.Add(MountData(str));
@@ -304,12 +619,13 @@ void MountManager::removeMountedData(const MountData& inData)
 
 void MountManager::resetConfigMountedData(const TArray<MountData>& datas)
 {
-	FString configPath = Utilities::Get().GetProjectConfigPath();
+	FString configPath = getProjectConfigPath();
 	TArray<FString> dataStrs;
 	config2StrArr(dataStrs, datas);
 	GConfig->SetArray(*mSectionName, TEXT("MountedDirs"), dataStrs, *configPath);
 	GConfig->Flush(false, *configPath);
 	mMountedDatas = datas;
+	++mMountedDatasRevision;
 }
 
 void MountManager::readonlyFolder(const FString& folder)
@@ -355,176 +671,626 @@ void MountManager::StrArr2Config(const TArray<FString>& strArr, TArray<MountData
 
 void MountManager::loadMountConfigs()
 {
-	FString configFile = Utilities::Get().GetPluginConfigPath();
+	FString configFile = getPluginConfigPath();
+	MountConfigSnapshot snapshot;
+	snapshot.Load(configFile);
+
 	// Mount rules
-	TMap<FString, FString> rules;
-	TArray<FString> values;
-	if (GConfig->GetArray(TEXT("MountRule"), TEXT("Rule"), values, *configFile)) {
-		for (FString value : values) {
-			FString entry = FString(value);
-			entry.RemoveFromStart(TEXT("("));
-			entry.RemoveFromEnd(TEXT(")"));
-
-			FString subDir;
-			if (FParse::Value(*entry, TEXT("SubDir="), subDir)) {
-				rules.Add(subDir, entry);
-				UE_LOG(LogTemp, Log, TEXT("Mount rule:%s -> %s"), *subDir, *entry);
-			}
-		}
+	mMountRules = snapshot.Rules;
+	for (const MountRule& rule : mMountRules) {
+		UE_LOG(LogTemp, Log, TEXT("Mount rule:%s -> %s"), *rule.SubDir, *rule.Entry);
 	}
-	mMountRules = rules;
 
-	mReadonlyMountPath.Empty();
-	TArray<FString> readonlyPaths;
-	if (GConfig->GetArray(TEXT("ReadonlyMountPath"), TEXT("Path"), readonlyPaths, *configFile)) {
-		for (FString path : readonlyPaths) {
-			FString readonlyPath = path;
-			mReadonlyMountPath.Add(readonlyPath);
-		}
+	mReadonlyMountPath = snapshot.ReadonlyMountPaths;
+	mMountNeedLogDirs = snapshot.MountNeedLogDirs;
+	bLegacyTextLog = snapshot.bLegacyTextLog;
+	mSignFormatter.SetNeedLogDirs(mMountNeedLogDirs);
+	mPointRegistry.SetPolicy(MountPointRegistry::ParsePolicy(snapshot.CollisionPolicy));
+	if (bLegacyTextLog) {
+		// Host fields of the txt lines, looked up once instead of per sign
+		bool bBindAll = false;
+		TSharedRef<FInternetAddr> localIp = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLocalHostAddr(*GLog, bBindAll);
+		mSignFormatter.SetHost(FPlatformProcess::ComputerName(), FPlatformProcess::UserName(), localIp->IsValid() ? localIp->ToString(false) : FString());
 	}
 
+	// Local cache has to be in the file chain before anything on the roots is mounted
+	if (snapshot.bCacheEnabled && !bIsolated) {
+		MountCacheSettings cacheSettings;
+		cacheSettings.CacheDir = snapshot.CacheDir.IsEmpty() ? FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("MountCache")) : snapshot.CacheDir;
+		cacheSettings.MaxSizeBytes = (int64)FMath::Max(snapshot.CacheMaxSizeMB, 1) * 1024 * 1024;
+		if (snapshot.CacheValidation.Equals(TEXT("Size"))) cacheSettings.Validation = MountCacheValidation::Size;
+		else if (snapshot.CacheValidation.Equals(TEXT("Hash"))) cacheSettings.Validation = MountCacheValidation::Hash;
+		cacheSettings.Roots = snapshot.CacheRoots;
+		cacheSettings.ReadonlyWords = mReadonlyMountPath;
+		MountCachePlatformFile::Install(cacheSettings);
+	}
+
+	if (snapshot.bWarmupEnabled && !bIsolated) {
+		MountWarmupSettings warmupSettings;
+		warmupSettings.MaxConcurrency = snapshot.WarmupMaxConcurrency;
+		warmupSettings.MaxBytesPerSecond = (int64)snapshot.WarmupMaxMBPerSecond * 1024 * 1024;
+		warmupSettings.HeaderBytes = (int64)snapshot.WarmupHeaderKB * 1024;
+		MountWarmup::Get().Configure(warmupSettings);
+	}
+
+	// Optional asset folder
+	mOptionalDirs.Append(snapshot.OptionalDirs);
+
+	// must mount dirs
+	mMustMountDirs.Append(snapshot.MustMountDirs);
+
 	// Mount log path
-	//GConfig->GetString(TEXT("MountLogRootPath"), TEXT("Path"), mMountLogPath, *configFile);
-	TArray<FString> mountPathConfigs;
-	if (GConfig->GetArray(TEXT("MountLogRootPath"), TEXT("Path"), mountPathConfigs, *configFile)) {
-		for (FString path : mountPathConfigs) {
-			if (FPaths::DirectoryExists(path))
+	resolveMountLogPath(snapshot.MountLogRootPaths);
+}
+
+void MountManager::resolveMountLogPath(const TArray<FString>& candidates)
+{
+	mMountLogPath.Empty();
+	bMountLogPathResolved = false;
+	const uint32 request = ++mMountLogPathRequest;
+
+	// Log roots are network shares, don't make startup wait on them
+	Async(EAsyncExecution::ThreadPool, [this, candidates, request]() {
+		FString found;
+		DirectoryWalker walker;
+		for (const FString& path : candidates) {
+			if (walker.DirectoryExists(path))
 			{
-				mMountLogPath = path;
+				found = path;
 				break;
 			}
 		}
+
+		AsyncTask(ENamedThreads::GameThread, [this, found, request]() {
+			if (request != mMountLogPathRequest) return;
+
+			mMountLogPath = found;
+			mTextLog.SetRoot(found);
+			bMountLogPathResolved = true;
+			auditStore().Open(found);
+			// Signs a previous session could not write go first, they are older
+			TArray<PendingMountSign> pending;
+			if (!found.IsEmpty()) {
+				loadPendingMountSigns(pending);
+			}
+			pending.Append(MoveTemp(mPendingMountSigns));
+			mPendingMountSigns.Empty();
+			for (const PendingMountSign& sign : pending) {
+				writeMountSign(sign.Dir, sign.Content, sign.Date);
+			}
+		});
+	});
+}
+
+FString MountManager::getPendingMountSignsPath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("Mount") / TEXT("PendingMountSigns.json");
+}
+
+void MountManager::savePendingMountSigns()
+{
+	// A benchmark's signs are not the user's
+	if (bIsolated || mPendingMountSigns.Num() == 0) return;
+
+	const FString file = getPendingMountSignsPath();
+	TArray<PendingMountSign> signs;
+	loadPendingMountSigns(signs);
+	signs.Append(mPendingMountSigns);
+
+	TArray<TSharedPtr<FJsonValue>> values;
+	values.Reserve(signs.Num());
+	for (const PendingMountSign& sign : signs) {
+		TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+		object->SetStringField(TEXT("Dir"), sign.Dir);
+		object->SetStringField(TEXT("Content"), sign.Content);
+		// Ticks do not fit a double
+		object->SetStringField(TEXT("Ticks"), LexToString(sign.Date.GetTicks()));
+		values.Add(MakeShared<FJsonValueObject>(object));
 	}
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	root->SetArrayField(TEXT("Signs"), values);
 
-	mMountNeedLogDirs.Empty();
-	TArray<FString> needLogDirs;
-	if (GConfig->GetArray(TEXT("MountNeedLogDir"), TEXT("Path"), needLogDirs, *configFile))
-	{
-		for (FString path : needLogDirs) {
-			mMountNeedLogDirs.Add(FString(path));
-		}
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+	if (!FFileHelper::SaveStringToFile(json, *file)) {
+		UE_LOG(LogTemp, Warning, TEXT("Mount log root not found before shutdown, %d signs lost"), mPendingMountSigns.Num());
 	}
+}
 
-	// Optional asset folder
-	FKeyValueSink visitor;
-	visitor.BindLambda([=](const TCHAR *Key, const TCHAR* Value) {
-		mOptionalDirs.Add(Key, Value);
-	});
-	GConfig->ForEachEntry(visitor, TEXT("OptionalMountList"), *configFile);
+void MountManager::loadPendingMountSigns(TArray<PendingMountSign>& outSigns)
+{
+	if (bIsolated) return;
 
-	// must mount dirs
-	FKeyValueSink MustMountVisitor;
-	MustMountVisitor.BindLambda([=](const TCHAR* Key, const TCHAR* Value) {
-		mMustMountDirs.Add(Key, Value);
-	});
-	GConfig->ForEachEntry(MustMountVisitor, TEXT("Server"), *configFile);
+	const FString file = getPendingMountSignsPath();
+	FString json;
+	if (!FFileHelper::LoadFileToString(json, *file)) return;
+	IFileManager::Get().Delete(*file, false, true, true);
+
+	TSharedPtr<FJsonObject> root;
+	const TArray<TSharedPtr<FJsonValue>>* values = nullptr;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), root) || !root.IsValid()
+		|| !root->TryGetArrayField(TEXT("Signs"), values)) {
+		return;
+	}
+	for (const TSharedPtr<FJsonValue>& value : *values) {
+		const TSharedPtr<FJsonObject>* object = nullptr;
+		if (!value->TryGetObject(object)) continue;
+
+		PendingMountSign& sign = outSigns.AddDefaulted_GetRef();
+		sign.Dir = (*object)->GetStringField(TEXT("Dir"));
+		sign.Content = (*object)->GetStringField(TEXT("Content"));
+		int64 ticks = 0;
+		LexFromString(ticks, *(*object)->GetStringField(TEXT("Ticks")));
+		sign.Date = FDateTime(ticks);
+	}
 }
 
 void MountManager::writeMountSign(const FString& dir, const FString& content)
 {
-	// Init failed
-	if (!FPaths::DirectoryExists(mMountLogPath))
+	if (!bMountLogPathResolved)
+	{
+		mPendingMountSigns.Add({ dir, content, FDateTime::Now() });
+		return;
+	}
+	writeMountSign(dir, content, FDateTime::Now());
+}
+
+void MountManager::writeMountSign(const FString& dir, const FString& content, const FDateTime& date)
+{
+	// Init failed, existence was already checked by resolveMountLogPath
+	if (mMountLogPath.IsEmpty())
 		return;
 
 	// Not in check, ignore 
-	bool needWrite = false;
-	for (auto checkStr : mMountNeedLogDirs)
+	if (!mSignFormatter.IsLogged(dir)) return;
+
+	auditStore().Append(dir, content, date);
+	if (!bLegacyTextLog) return;
+
+	// One txt per user and folder, written from the formatter's buffers
+	mTextLog.Write(dir, MountSignFormatter::FormatLogSubPath(dir), mSignFormatter.FormatText(date, content));
+}
+
+void MountManager::writeAssetMountDirs()
+{
+	FString ret = TEXT("(Level=\"{0}\",Dirs=\"{1}\")");
+	TArray<FString> dirs;
+	for (MountPathId dir : mAssetMountDirs)
 	{
-		if (dir.Contains(checkStr)) {
-			needWrite = true;
-			break;
-		}
+		dirs.Add(mPathTable.ToString(dir));
 	}
-	if (!needWrite) return;
+	FString Dirs = FString::Join(dirs, TEXT(","));
+	auto World = GEditor->GetAllViewportClients()[0]->GetWorld();
+	FString Level = World->GetName();
+	ret = FString::Format(*ret, { Level, Dirs });
+	FString configPath = getProjectConfigPath();
+	GConfig->SetString(*mAssetSection, TEXT("MountedPaths"), *ret, *configPath);
+	GConfig->Flush(false, *configPath);
+	mAssetMountDirs.Empty();
+}
 
-	FString userName = FPlatformProcess::UserName();
-	FString comName = FPlatformProcess::ComputerName();
-	FString IpName = TEXT("");
-	bool bBindAll = false;
-	TSharedRef<FInternetAddr> localIp = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLocalHostAddr(*GLog, bBindAll);
-	if (localIp->IsValid())
+namespace
+{
+	FString makeStrictMountPoint(const FString& point)
 	{
-		IpName = localIp->ToString(false);
+		return point.EndsWith(TEXT("/")) ? point : point + TEXT("/");
 	}
 
-	FDateTime date = FDateTime::Now();
-	FString logContent = FString::Printf(TEXT("%s  -  %s  -  %s  -  %s  -  %s"), *date.ToString(), *comName, *userName, *IpName, *content);
-	// Construct log path
-	FString middlePath;
-	if (dir.Contains(TEXT(":/")))
+	// Folder the root sits in, "D:/Lib/Rocks/Content" and "D:/Lib/Rocks/Art" -> "Rocks"
+	FString getMountNamespace(const FString& root)
 	{
-		FString l, r;
-		dir.Split(TEXT(":/"), &l, &r);
-		middlePath = l + TEXT("/") + r;
+		FString path = root;
+		path.RemoveFromEnd(TEXT("/"));
+		return FPaths::GetCleanFilename(FPaths::GetPath(path));
 	}
-	else if (dir.Contains(TEXT("//")))
-	{
-		middlePath = FString(dir);
-		middlePath.RemoveFromStart(TEXT("//"));
+}
+
+void MountManager::AddMountPoint(FString Point, FString Path)
+{
+	FString StrictPoint = makeStrictMountPoint(Point);
+
+	const MountPathId pointId = mPathTable.Intern(StrictPoint);
+	const MountPathId pathId = mPathTable.Intern(Path);
+	mPointRegistry.Register(pointId, pathId);
+	mMountPoints.Add(pointId, pathId);
+	if (pointId != mGameMountPointId) mMountPaths.Add(pointId);
+	FPackageName::RegisterMountPoint(getEngineMountPoint(StrictPoint), Path);
+	mPathToMountPoint.Add(pathId, pointId);
+}
+
+void MountManager::RemoveMountPoint(MountPathId pointId, MountPathId pathId)
+{
+	FPackageName::UnRegisterMountPoint(getEngineMountPoint(mPathTable.ToString(pointId)), mPathTable.ToString(pathId));
+	mMountPoints.Remove(pointId);
+	mMountPaths.Remove(pointId);
+	mPathToMountPoint.Remove(pathId);
+	mPointRegistry.Unregister(pointId);
+}
+
+FString MountManager::getEngineMountPoint(const FString& point) const
+{
+	if (!bIsolated || !point.StartsWith(mMountPoint)) return point;
+	// "/Game/A/" -> "/MountBench/A/", the engine still does its part without shadowing the project's folders
+	return mIsolatedMountPoint + point.RightChop(mMountPoint.Len());
+}
+
+void MountManager::addMountPointRequests(const MountPlan& plan, TArray<MountPointRequest>& outRequests)
+{
+	const FString nameSpace = getMountNamespace(plan.Root);
+	for (const TPair<FString, FString>& point : plan.Points) {
+		MountPointRequest& request = outRequests.AddDefaulted_GetRef();
+		request.Point = mPathTable.Intern(makeStrictMountPoint(point.Key));
+		request.Folder = mPathTable.Intern(point.Value);
+		request.Namespace = nameSpace;
 	}
+}
+
+void MountManager::validateMountPlan(MountPlan& plan, TArray<MountCollision>& outCollisions)
+{
+	TArray<MountPointRequest> requests;
+	addMountPointRequests(plan, requests);
 
-	FString logDir = FPaths::Combine(mMountLogPath, middlePath);
+	TArray<TPair<FString, FString>> points;
+	points.Reserve(requests.Num());
+	for (int32 i = 0; i < requests.Num(); ++i) {
+		const MountPathId resolved = mPointRegistry.Resolve(requests[i], &outCollisions);
+		if (!resolved.IsValid()) continue;
 
-	// Find log file for me
-	FString tempLogFileName = TEXT("");
-	FString newLogFileName = logContent + TEXT(".txt");
-	TArray<FString> txtList;
-	IFileManager& fileMgr = IFileManager::Get();
-	fileMgr.FindFilesRecursive(txtList, *logDir, TEXT("*.txt"), true, false, false);
-	for (auto txt : txtList)
+		// Taken right away, later points of the same plan see it
+		mPointRegistry.Register(resolved, requests[i].Folder);
+		points.Emplace(resolved == requests[i].Point ? plan.Points[i].Key : mPathTable.ToString(resolved), plan.Points[i].Value);
+	}
+	plan.Points = MoveTemp(points);
+}
+
+void MountManager::validateMountDatas(const TArray<MountData>& datas, bool bReplaceMounts, TMap<MountPathId, MountPathId>& outResolved, TArray<MountCollision>& outCollisions)
+{
+	DirectoryWalker walker;
+	TArray<MountPointRequest> requests;
+	for (const MountData& data : datas) {
+		MountPlan plan;
+		planMountPoint(data.RootDir, plan, walker, &data.SubDirs);
+		addMountPointRequests(plan, requests);
+	}
+	mPointRegistry.Validate(requests, bReplaceMounts, outResolved, outCollisions);
+}
+
+int32 MountManager::ValidateMountConfig()
+{
+	TArray<MountData> datas;
+	getMountedData(datas);
+	TMap<MountPathId, MountPathId> resolved;
+	TArray<MountCollision> collisions;
+	validateMountDatas(datas, true, resolved, collisions);
+	reportCollisions(collisions, false);
+	UE_LOG(LogTemp, Log, TEXT("Validated %d mount points of %d roots: %d clashes"), resolved.Num(), datas.Num(), collisions.Num());
+	return collisions.Num();
+}
+
+void MountManager::reportCollisions(const TArray<MountCollision>& collisions, bool bNotify)
+{
+	for (const MountCollision& collision : collisions) {
+		UE_LOG(LogTemp, Warning, TEXT("Mount point %s for %s is held by %s, %s"), *collision.MountPoint, *collision.Folder, *collision.Owner,
+			collision.Resolved.IsEmpty() ? TEXT("not mounted") : *FString::Printf(TEXT("mounted at %s"), *collision.Resolved));
+	}
+	if (!bNotify || bIsolated || collisions.Num() == 0) return;
+
+	const FText text = FText::Format(LOCTEXT("MountPointClash", "{0} folders clash with mounted /Game/ folders, see the output log"), FText::AsNumber(collisions.Num()));
+	auto notify = [text]() {
+		FNotificationInfo info(text);
+		info.ExpireDuration = 8.f;
+		FSlateNotificationManager::Get().AddNotification(info);
+	};
+	// Startup clashes are found before there is a window to show them in
+	if (GIsRunning) notify();
+	else FCoreDelegates::OnFEngineLoopInitComplete.AddLambda(notify);
+}
+
+void MountManager::publishMountState()
+{
+	// Built in full before publishing, readers only ever see complete snapshots
+	TSharedRef<MountStateSnapshot, ESPMode::ThreadSafe> snapshot = MakeShared<MountStateSnapshot, ESPMode::ThreadSafe>();
+	snapshot->Revision = ++mMountStateRevision;
+	snapshot->FolderToMountPoint.Reserve(mPathToMountPoint.Num());
+	for (const TPair<MountPathId, MountPathId>& pair : mPathToMountPoint) {
+		FString folder = mPathTable.ToString(pair.Key);
+		if (!folder.EndsWith(TEXT("/"))) folder += TEXT("/");
+		snapshot->FolderToMountPoint.Add(MoveTemp(folder), mPathTable.ToString(pair.Value));
+	}
+	for (const TPair<MountPathId, MountPathId>& pair : mMountPoints) {
+		snapshot->MountPoints.Add(mPathTable.ToString(pair.Key));
+	}
+	for (const MountData& data : mMountedDatas) {
+		snapshot->MountedRoots.Add(data.RootDir);
+	}
+	mMountState.Publish(snapshot);
+}
+
+// Mount profiles...
+namespace
+{
+	// (Name="Art",RootDirs="D:/Lib/Art,//server/share/Props")
+	bool parseMountProfile(const FString& entry, FString& outName, TArray<FString>& outRoots)
 	{
-		if (txt.Contains(userName))
-		{
-			tempLogFileName = FString(txt);
-			break;
+		FString value = entry;
+		value.RemoveFromStart(TEXT("("));
+		value.RemoveFromEnd(TEXT(")"));
+		if (!FParse::Value(*value, TEXT("Name="), outName)) return false;
+
+		FString roots;
+		if (FParse::Value(*value, TEXT("RootDirs="), roots)) {
+			roots.ParseIntoArray(outRoots, TEXT(","));
 		}
+		return true;
 	}
+}
 
-	FString newLogPath = FPaths::Combine(logDir, newLogFileName);
-	if (FPaths::FileExists(tempLogFileName)) {
-		TArray<FString> strArr;
-		FFileHelper::LoadFileToStringArray(strArr, *tempLogFileName);
-		strArr.Add(logContent);
-		FFileHelper::SaveStringArrayToFile(strArr, *tempLogFileName);
-		fileMgr.Move(*newLogPath, *tempLogFileName);
-	}
-	else {
-		FFileHelper::SaveStringToFile(logContent, *newLogPath);
+TArray<FString> MountManager::GetMountProfileNames() const
+{
+	TArray<FString> entries, names;
+	GConfig->GetArray(*mSectionName, TEXT("MountProfiles"), entries, getProjectConfigPath());
+	for (const FString& entry : entries) {
+		FString name;
+		TArray<FString> roots;
+		if (parseMountProfile(entry, name, roots)) names.Add(name);
 	}
+	return names;
 }
 
-void MountManager::writeAssetMountDirs()
+void MountManager::SaveMountProfile(const FString& name)
 {
-	FString ret = TEXT("(Level=\"{0}\",Dirs=\"{1}\")");
-	FString Dirs = FString::Join(mAssetMountDirs, TEXT(","));
-	auto World = GEditor->GetAllViewportClients()[0]->GetWorld();
-	FString Level = World->GetName();
-	ret = FString::Format(*ret, { Level, Dirs });
-	FString configPath = Utilities::Get().GetProjectConfigPath();
-	GConfig->SetString(*mAssetSection, TEXT("MountedPaths"), *ret, *configPath);
+	TArray<FString> roots;
+	for (const MountData& data : mMountedDatas) {
+		roots.AddUnique(data.RootDir);
+	}
+
+	FString configPath = getProjectConfigPath();
+	TArray<FString> entries;
+	GConfig->GetArray(*mSectionName, TEXT("MountProfiles"), entries, *configPath);
+	entries.RemoveAll([&name](const FString& entry) {
+		FString entryName;
+		TArray<FString> entryRoots;
+		return parseMountProfile(entry, entryName, entryRoots) && entryName.Equals(name);
+	});
+	entries.Add(FString::Format(TEXT("(Name=\"{0}\",RootDirs=\"{1}\")"), { name, FString::Join(roots, TEXT(",")) }));
+
+	GConfig->SetArray(*mSectionName, TEXT("MountProfiles"), entries, *configPath);
+	GConfig->SetString(*mSectionName, TEXT("ActiveProfile"), *name, *configPath);
 	GConfig->Flush(false, *configPath);
-	mAssetMountDirs.Empty();
+	UE_LOG(LogTemp, Log, TEXT("Saved mount profile %s with %d roots"), *name, roots.Num());
 }
 
-void MountManager::AddMountPoint(FString Point, FString Path)
+bool MountManager::SwitchMountProfile(const FString& name)
 {
-	FString StrictPoint = Point;
-	if (!StrictPoint.EndsWith(TEXT("/")))
+	FString configPath = getProjectConfigPath();
+	TArray<FString> entries, roots;
+	GConfig->GetArray(*mSectionName, TEXT("MountProfiles"), entries, *configPath);
+	const bool bFound = entries.ContainsByPredicate([&](const FString& entry) {
+		FString entryName;
+		roots.Reset();
+		return parseMountProfile(entry, entryName, roots) && entryName.Equals(name);
+	});
+	if (!bFound) {
+		UE_LOG(LogTemp, Warning, TEXT("No mount profile named %s"), *name);
+		return false;
+	}
+
+	// Queued background mounts belong to the set being replaced
+	if (mMountScheduler.IsValid()) {
+		mMountScheduler->Cancel();
+		mMountScheduler.Reset();
+	}
+
+	// Plan the whole profile before touching anything
+	DirectoryWalker walker;
+	TArray<MountPlan> plans;
+	plans.SetNum(roots.Num());
+	TArray<MountPointRequest> requests;
+	for (int32 i = 0; i < roots.Num(); ++i) {
+		planMountPoint(roots[i], plans[i], walker);
+		addMountPointRequests(plans[i], requests);
+	}
+
+	// Clashes are resolved over the whole profile, the current mounts are the ones being replaced
+	TMap<MountPathId, MountPathId> resolved;
+	TArray<MountCollision> collisions;
+	mPointRegistry.Validate(requests, true, resolved, collisions);
+	TMap<MountPathId, MountPathId> wanted;
+	for (const TPair<MountPathId, MountPathId>& pair : resolved) {
+		if (pair.Value.IsValid()) wanted.Add(pair.Key, pair.Value);
+	}
+
+	// Delta against what is registered now
+	TArray<TPair<MountPathId, MountPathId>> removed;
+	for (const TPair<MountPathId, MountPathId>& current : mPathToMountPoint) {
+		const MountPathId* point = wanted.Find(current.Key);
+		if (!point || *point != current.Value) removed.Emplace(current.Value, current.Key);
+	}
+	TArray<TPair<FString, FString>> added;
+	for (const TPair<MountPathId, MountPathId>& want : wanted) {
+		const MountPathId* point = mPathToMountPoint.Find(want.Key);
+		if (!point || *point != want.Value) added.Emplace(mPathTable.ToString(want.Value), mPathTable.ToString(want.Key));
+	}
+
+	for (const TPair<MountPathId, MountPathId>& point : removed) {
+		UE_LOG(LogTemp, Log, TEXT("unmount:%s -> %s"), *mPathTable.ToString(point.Key), *mPathTable.ToString(point.Value));
+		RemoveMountPoint(point.Key, point.Value);
+	}
+	if (!bIsolated) MountWarmup::Get().Enqueue(added);
+	for (const TPair<FString, FString>& point : added) {
+		AddMountPoint(point.Key, point.Value);
+		UE_LOG(LogTemp, Log, TEXT("mount:%s -> %s"), *point.Key, *point.Value);
+	}
+	// After the removals, unmounting a folder drops what was reserved for it
+	mPointRegistry.SetReserved(MoveTemp(resolved));
+	reportCollisions(collisions, true);
+
+	// Signs per root, not per mount point
+	TSet<FString> oldRoots, newRoots(roots);
+	for (const MountData& data : mMountedDatas) {
+		oldRoots.Add(data.RootDir);
+	}
+	for (const FString& root : oldRoots) {
+		if (!newRoots.Contains(root)) writeMountSign(root, TEXT("Remove Mount Point"));
+	}
+	for (const FString& root : newRoots) {
+		if (!oldRoots.Contains(root)) {
+			readonlyFolder(root);
+			writeMountSign(root, TEXT("Start Mount"));
+		}
+	}
+
+	// One config flush
+	TArray<MountData> datas;
+	for (const MountPlan& plan : plans) {
+		for (const FString& requirePath : plan.RequiredDirs) {
+			if (!datas.ContainsByPredicate([&requirePath](const MountData& data) { return data.RootDir.Equals(requirePath); })) {
+				datas.Add(MountData(requirePath, requirePath));
+			}
+		}
+		if (plan.SubDirs.Num() > 0) {
+			MountData data;
+			data.RootDir = plan.Root;
+			data.SubDirs = plan.SubDirs;
+			datas.Add(data);
+		}
+	}
+	GConfig->SetString(*mSectionName, TEXT("ActiveProfile"), *name, *configPath);
+	resetConfigMountedData(datas);
+	publishMountState();
+
+	// One registry scan for everything that appeared
+	TArray<FString> scanPaths;
+	for (const TPair<FString, FString>& point : added) {
+		scanPaths.AddUnique(makeStrictMountPoint(point.Key));
+	}
+	if (scanPaths.Num() > 0) {
+		IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		assetRegistry.ScanPathsSynchronous(scanPaths, false);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Switched to mount profile %s: %d mount points added, %d removed, %d filesystem calls"),
+		*name, added.Num(), removed.Num(), walker.GetNumCalls());
+	return true;
+}
+
+// Mount.Profile.Save <Name>
+static FAutoConsoleCommand GMountProfileSaveCommand(
+	TEXT("Mount.Profile.Save"),
+	TEXT("Save the mounted roots as a named profile in the project config"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 1) {
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.Profile.Save <Name>"));
+			return;
+		}
+		MountManager::Get().SaveMountProfile(Args[0]);
+	})
+);
+
+// Mount.Profile.Switch <Name>
+static FAutoConsoleCommand GMountProfileSwitchCommand(
+	TEXT("Mount.Profile.Switch"),
+	TEXT("Mount the roots of a saved profile, unmounting roots it does not have"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 1) {
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.Profile.Switch <Name>, profiles: %s"),
+				*FString::Join(MountManager::Get().GetMountProfileNames(), TEXT(", ")));
+			return;
+		}
+		MountManager::Get().SwitchMountProfile(Args[0]);
+	})
+);
+
+// Mount.Points.Validate
+static FAutoConsoleCommand GMountPointsValidateCommand(
+	TEXT("Mount.Points.Validate"),
+	TEXT("Check the mounted roots of the project config for /Game/ mount point clashes without mounting anything"),
+	FConsoleCommandDelegate::CreateLambda([]() {
+		MountManager::Get().ValidateMountConfig();
+	})
+);
+
+namespace
+{
+	struct PathBookkeepingSize
+	{
+		SIZE_T Interned = 0;
+		SIZE_T Strings = 0;
+	};
+
+	template <typename ContainerType>
+	SIZE_T stringsSize(const ContainerType& strings)
 	{
-		StrictPoint += TEXT("/");
+		SIZE_T size = strings.GetAllocatedSize();
+		for (const FString& str : strings) size += str.GetAllocatedSize();
+		return size;
 	}
 
-	mMountPoints.Add(StrictPoint, Path);
-	if (StrictPoint != mMountPoint)	mMountPaths.AddUnique(StrictPoint);
-	FPackageName::RegisterMountPoint(StrictPoint, Path);
-	if (mPathToMountPoint.Contains(Path))
+	PathBookkeepingSize measurePathBookkeeping(const MountPathTable& table, const TMap<MountPathId, MountPathId>& mountPoints,
+		const TMap<MountPathId, MountPathId>& pathToMountPoint, const TSet<MountPathId>& mountPaths)
 	{
-		mPathToMountPoint[Path] = StrictPoint;
+		PathBookkeepingSize result;
+		result.Interned = table.GetAllocatedSize() + mountPoints.GetAllocatedSize() + pathToMountPoint.GetAllocatedSize() + mountPaths.GetAllocatedSize();
+
+		// Rebuild the FString containers this replaced and measure them
+		auto stringMapSize = [&table](const TMap<MountPathId, MountPathId>& ids) {
+			TMap<FString, FString> strings;
+			strings.Reserve(ids.Num());
+			SIZE_T size = 0;
+			for (const TPair<MountPathId, MountPathId>& pair : ids)
+			{
+				const FString& value = strings.Add(table.ToString(pair.Key), table.ToString(pair.Value));
+				size += value.GetAllocatedSize();
+			}
+			for (const TPair<FString, FString>& pair : strings) size += pair.Key.GetAllocatedSize();
+			return size + strings.GetAllocatedSize();
+		};
+		TArray<FString> paths;
+		for (MountPathId id : mountPaths) paths.Add(table.ToString(id));
+		result.Strings = stringMapSize(mountPoints) + stringMapSize(pathToMountPoint) + stringsSize(paths);
+		return result;
 	}
-	else
+
+	void logPathBookkeeping(const TCHAR* label, int32 numMounts, const MountPathTable& table, const PathBookkeepingSize& size)
 	{
-		mPathToMountPoint.Add(Path, StrictPoint);
+		UE_LOG(LogTemp, Log, TEXT("%s: %d mounts, %d path nodes, %d segments, interned %.1f KB, as strings %.1f KB"), label, numMounts,
+			table.NumNodes(), table.NumSegments(), size.Interned / 1024.0, size.Strings / 1024.0);
 	}
 }
 
+void MountManager::ReportPathMemory() const
+{
+	logPathBookkeeping(TEXT("Mount paths"), mMountPoints.Num(), mPathTable,
+		measurePathBookkeeping(mPathTable, mMountPoints, mPathToMountPoint, mMountPaths));
+}
+
+// Mount.PathTable.Report [SyntheticMounts]
+static FAutoConsoleCommand GMountPathTableReportCommand(
+	TEXT("Mount.PathTable.Report"),
+	TEXT("Log mount path memory. With a count, measure a synthetic mount set of that size instead"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const int32 numMounts = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+		if (numMounts <= 0)
+		{
+			MountManager::Get().ReportPathMemory();
+			return;
+		}
+
+		// Library layout as seen on the shares: many folders under few Content roots
+		MountPathTable table;
+		TMap<MountPathId, MountPathId> mountPoints, pathToMountPoint;
+		TSet<MountPathId> mountPaths;
+		for (int32 i = 0; i < numMounts; ++i)
+		{
+			const MountPathId point = table.Intern(FString::Printf(TEXT("/Game/Folder%05d/"), i));
+			const MountPathId path = table.Intern(FString::Printf(TEXT("//fileserver/share/Projects/Library%03d/Content/Folder%05d"), i / 100, i));
+			mountPoints.Add(point, path);
+			pathToMountPoint.Add(path, point);
+			mountPaths.Add(point);
+		}
+		logPathBookkeeping(TEXT("Synthetic mount paths"), numMounts, table, measurePathBookkeeping(table, mountPoints, pathToMountPoint, mountPaths));
+	})
+);
+
 #undef LOCTEXT_NAMESPACE 
\ No newline at end of file
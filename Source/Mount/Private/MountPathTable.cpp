@@ -0,0 +1,144 @@
+#include "MountPathTable.h"
+
+namespace
+{
+	// Splits on both separators and keeps empty segments, so joining with '/' gives the path back
+	// including leading "//" of UNC paths and the trailing '/' of mount points
+	template <typename FuncType>
+	bool forEachSegment(const FString& path, FuncType func)
+	{
+		int32 start = 0;
+		const int32 len = path.Len();
+		for (int32 i = 0; i <= len; ++i)
+		{
+			if (i == len || path[i] == TEXT('/') || path[i] == TEXT('\\'))
+			{
+				if (!func(path.Mid(start, i - start))) return false;
+				start = i + 1;
+			}
+		}
+		return true;
+	}
+}
+
+int32 MountPathTable::findSegment(const FString& segment) const
+{
+	const int32* found = mSegmentIds.Find(segment);
+	return found ? *found : INDEX_NONE;
+}
+
+MountPathId MountPathTable::Intern(const FString& path)
+{
+	int32 node = INDEX_NONE;
+	forEachSegment(path, [this, &node](const FString& segment) {
+		int32 segmentId = findSegment(segment);
+		if (segmentId == INDEX_NONE)
+		{
+			segmentId = mSegments.Add(segment);
+			mSegmentIds.Add(segment, segmentId);
+		}
+
+		const uint64 key = childKey(node, segmentId);
+		if (const int32* child = mChildren.Find(key))
+		{
+			node = *child;
+		}
+		else
+		{
+			const int32 parent = node;
+			node = mNodes.Add({ parent, segmentId });
+			mChildren.Add(key, node);
+		}
+		return true;
+	});
+
+	MountPathId id;
+	id.Index = node;
+	return id;
+}
+
+MountPathId MountPathTable::Find(const FString& path) const
+{
+	int32 node = INDEX_NONE;
+	const bool bFound = forEachSegment(path, [this, &node](const FString& segment) {
+		const int32 segmentId = findSegment(segment);
+		const int32* child = segmentId != INDEX_NONE ? mChildren.Find(childKey(node, segmentId)) : nullptr;
+		if (!child) return false;
+		node = *child;
+		return true;
+	});
+
+	MountPathId id;
+	id.Index = bFound ? node : INDEX_NONE;
+	return id;
+}
+
+FString MountPathTable::ToString(MountPathId id) const
+{
+	if (!mNodes.IsValidIndex(id.Index)) return FString();
+
+	TArray<int32, TInlineAllocator<32>> chain;
+	int32 len = 0;
+	for (int32 node = id.Index; node != INDEX_NONE; node = mNodes[node].Parent)
+	{
+		chain.Add(node);
+		len += mSegments[mNodes[node].Segment].Len() + 1;
+	}
+
+	FString result;
+	result.Reserve(len);
+	for (int32 i = chain.Num() - 1; i >= 0; --i)
+	{
+		result += mSegments[mNodes[chain[i]].Segment];
+		if (i > 0) result += TEXT('/');
+	}
+	return result;
+}
+
+MountPathId MountPathTable::GetParent(MountPathId id) const
+{
+	MountPathId parent;
+	if (mNodes.IsValidIndex(id.Index))
+	{
+		parent.Index = mNodes[id.Index].Parent;
+	}
+	return parent;
+}
+
+MountPathId MountPathTable::TrimTrailingSeparator(MountPathId id) const
+{
+	if (mNodes.IsValidIndex(id.Index) && mSegments[mNodes[id.Index].Segment].IsEmpty() && mNodes[id.Index].Parent != INDEX_NONE)
+	{
+		return GetParent(id);
+	}
+	return id;
+}
+
+bool MountPathTable::IsUnder(MountPathId id, MountPathId ancestor) const
+{
+	if (!mNodes.IsValidIndex(ancestor.Index)) return false;
+
+	// "/Game/X/" ends in an empty segment, what is below it hangs off "/Game/X"
+	int32 target = ancestor.Index;
+	if (mSegments[mNodes[target].Segment].IsEmpty() && mNodes[target].Parent != INDEX_NONE)
+	{
+		target = mNodes[target].Parent;
+	}
+
+	for (int32 node = id.Index; mNodes.IsValidIndex(node); node = mNodes[node].Parent)
+	{
+		if (node == target) return true;
+	}
+	return false;
+}
+
+SIZE_T MountPathTable::GetAllocatedSize() const
+{
+	SIZE_T size = mNodes.GetAllocatedSize() + mChildren.GetAllocatedSize() + mSegments.GetAllocatedSize() + mSegmentIds.GetAllocatedSize();
+	for (const FString& segment : mSegments)
+	{
+		// Once in mSegments and once as a key of mSegmentIds
+		size += segment.GetAllocatedSize() * 2;
+	}
+	return size;
+}
@@ -0,0 +1,256 @@
+#include "MountPointRegistry.h"
+#include "DirectoryWalker.h"
+
+namespace
+{
+	// /Game/<Name>_2/ .. /Game/<Name>_99/
+	const int32 MaxAliases = 100;
+}
+
+void MountPointRegistry::Init(MountPathTable* table, MountPathId gameMountPoint)
+{
+	mTable = table;
+	mGameKey = table->TrimTrailingSeparator(gameMountPoint);
+	mOwners.Reset();
+	mFolderPoints.Reset();
+	mOwnedBelow.Reset();
+	mReserved.Reset();
+	mReservedPoints.Reset();
+}
+
+MountCollisionPolicy MountPointRegistry::ParsePolicy(const FString& name)
+{
+	if (name.Equals(TEXT("Alias"), ESearchCase::IgnoreCase)) return MountCollisionPolicy::Alias;
+	if (name.Equals(TEXT("Namespace"), ESearchCase::IgnoreCase)) return MountCollisionPolicy::Namespace;
+	return MountCollisionPolicy::Reject;
+}
+
+void MountPointRegistry::AddProjectFolders(const FString& contentDir, DirectoryWalker& walker)
+{
+	TArray<DirectoryEntry> entries;
+	walker.List(contentDir, entries);
+	const FString gamePath = mTable->ToString(mGameKey);
+	for (const DirectoryEntry& entry : entries)
+	{
+		if (!entry.bIsDirectory) continue;
+
+		Owner owner;
+		owner.Folder = mTable->Intern(entry.Path);
+		owner.bProject = true;
+		addOwner(mTable->Intern(gamePath / entry.GetName()), owner);
+	}
+}
+
+bool MountPointRegistry::isFree(MountPathId pointKey, MountPathId folder) const
+{
+	// "/Game/" itself is the project's, MountManager keeps it apart
+	if (pointKey == mGameKey) return true;
+
+	if (const Owner* owner = mOwners.Find(pointKey))
+	{
+		return owner->Folder == folder;
+	}
+	const MountPathId* reservedBy = mReservedPoints.Find(pointKey);
+	if (reservedBy && *reservedBy != folder) return false;
+	if (mFolderPoints.Contains(folder)) return false;
+
+	for (MountPathId node = mTable->GetParent(pointKey); node.IsValid() && node != mGameKey; node = mTable->GetParent(node))
+	{
+		if (mOwners.Contains(node)) return false;
+	}
+	return mOwnedBelow.FindRef(pointKey) == 0;
+}
+
+FString MountPointRegistry::describeClash(MountPathId pointKey, MountPathId folder) const
+{
+	if (const Owner* owner = mOwners.Find(pointKey))
+	{
+		return mTable->ToString(owner->Folder) + (owner->bProject ? TEXT(" (project content)") : TEXT(""));
+	}
+	if (const MountPathId* reservedBy = mReservedPoints.Find(pointKey))
+	{
+		if (*reservedBy != folder) return mTable->ToString(*reservedBy) + TEXT(" (reserved)");
+	}
+	if (const MountPathId* owned = mFolderPoints.Find(folder))
+	{
+		return TEXT("same folder at ") + mTable->ToString(*owned) + TEXT("/");
+	}
+	for (MountPathId node = mTable->GetParent(pointKey); node.IsValid() && node != mGameKey; node = mTable->GetParent(node))
+	{
+		if (mOwners.Contains(node)) return mTable->ToString(node) + TEXT("/");
+	}
+	// Only on a clash, finding which point is below is not worth an index
+	for (const TPair<MountPathId, Owner>& owner : mOwners)
+	{
+		if (owner.Key != pointKey && mTable->IsUnder(owner.Key, pointKey)) return mTable->ToString(owner.Key) + TEXT("/");
+	}
+	return FString();
+}
+
+MountPathId MountPointRegistry::findAlias(MountPathId pointKey, MountPathId folder)
+{
+	const FString parentPath = mTable->ToString(mTable->GetParent(pointKey));
+	const FString name = FPaths::GetCleanFilename(mTable->ToString(pointKey));
+	for (int32 n = 2; n < MaxAliases; ++n)
+	{
+		const MountPathId candidate = mTable->Intern(FString::Printf(TEXT("%s/%s_%d/"), *parentPath, *name, n));
+		if (isFree(key(candidate), folder)) return candidate;
+	}
+	return MountPathId();
+}
+
+MountPathId MountPointRegistry::Resolve(const MountPointRequest& request, TArray<MountCollision>* outCollisions)
+{
+	const MountPathId pointKey = key(request.Point);
+	if (const MountPathId* reserved = mReserved.Find(request.Folder))
+	{
+		// Rejected by Validate, which reported it, unless what held the point is gone since
+		if (!reserved->IsValid() && !isFree(pointKey, request.Folder)) return MountPathId();
+		if (reserved->IsValid() && isFree(key(*reserved), request.Folder)) return *reserved;
+	}
+
+	if (isFree(pointKey, request.Folder)) return request.Point;
+
+	MountPathId resolved;
+	// Packages of a folder mounted twice exist under two names, no policy makes that right
+	if (!mFolderPoints.Contains(request.Folder))
+	{
+		switch (mPolicy)
+		{
+		case MountCollisionPolicy::Alias:
+			resolved = findAlias(pointKey, request.Folder);
+			break;
+		case MountCollisionPolicy::Namespace:
+			if (!request.Namespace.IsEmpty())
+			{
+				const FString name = FPaths::GetCleanFilename(mTable->ToString(pointKey));
+				const MountPathId candidate = mTable->Intern(mTable->ToString(mGameKey) / request.Namespace / name + TEXT("/"));
+				if (isFree(key(candidate), request.Folder)) resolved = candidate;
+			}
+			break;
+		case MountCollisionPolicy::Reject:
+		default:
+			break;
+		}
+	}
+
+	if (outCollisions)
+	{
+		MountCollision& collision = outCollisions->AddDefaulted_GetRef();
+		collision.MountPoint = mTable->ToString(request.Point);
+		collision.Folder = mTable->ToString(request.Folder);
+		collision.Owner = describeClash(pointKey, request.Folder);
+		collision.Resolved = resolved.IsValid() ? mTable->ToString(resolved) : FString();
+	}
+	return resolved;
+}
+
+void MountPointRegistry::Register(MountPathId point, MountPathId folder)
+{
+	const MountPathId pointKey = key(point);
+	if (!pointKey.IsValid() || pointKey == mGameKey) return;
+
+	if (const Owner* owner = mOwners.Find(pointKey))
+	{
+		if (owner->Folder == folder) return;
+
+		// Only reachable by registering without Resolve
+		UE_LOG(LogTemp, Warning, TEXT("Mount point %s/ taken over from %s by %s"),
+			*mTable->ToString(pointKey), *mTable->ToString(owner->Folder), *mTable->ToString(folder));
+		removeOwner(pointKey);
+	}
+	if (const MountPathId* owned = mFolderPoints.Find(folder))
+	{
+		removeOwner(*owned);
+	}
+
+	Owner owner;
+	owner.Folder = folder;
+	addOwner(pointKey, owner);
+}
+
+void MountPointRegistry::Unregister(MountPathId point)
+{
+	const MountPathId pointKey = key(point);
+	const Owner* owner = mOwners.Find(pointKey);
+	if (!owner || owner->bProject) return;
+
+	// Unmounted on purpose, the startup decision for the folder no longer holds
+	const MountPathId folder = owner->Folder;
+	removeOwner(pointKey);
+	MountPathId reserved;
+	if (mReserved.RemoveAndCopyValue(folder, reserved) && reserved.IsValid())
+	{
+		mReservedPoints.Remove(key(reserved));
+	}
+}
+
+MountPathId MountPointRegistry::FindOwner(MountPathId point) const
+{
+	const Owner* owner = mOwners.Find(key(point));
+	return owner ? owner->Folder : MountPathId();
+}
+
+void MountPointRegistry::Validate(const TArray<MountPointRequest>& requests, bool bReplaceMounts, TMap<MountPathId, MountPathId>& outResolved, TArray<MountCollision>& outCollisions) const
+{
+	MountPointRegistry scratch(*this);
+	scratch.mReserved.Reset();
+	scratch.mReservedPoints.Reset();
+	if (bReplaceMounts) scratch.removeMounts();
+
+	outResolved.Reserve(outResolved.Num() + requests.Num());
+	for (const MountPointRequest& request : requests)
+	{
+		const MountPathId resolved = scratch.Resolve(request, &outCollisions);
+		outResolved.Add(request.Folder, resolved);
+		if (resolved.IsValid()) scratch.Register(resolved, request.Folder);
+	}
+}
+
+void MountPointRegistry::SetReserved(TMap<MountPathId, MountPathId>&& reserved)
+{
+	mReserved = MoveTemp(reserved);
+	mReservedPoints.Reset();
+	for (const TPair<MountPathId, MountPathId>& pair : mReserved)
+	{
+		if (pair.Value.IsValid()) mReservedPoints.Add(key(pair.Value), pair.Key);
+	}
+}
+
+void MountPointRegistry::addOwner(MountPathId pointKey, const Owner& owner)
+{
+	mOwners.Add(pointKey, owner);
+	mFolderPoints.Add(owner.Folder, pointKey);
+	for (MountPathId node = mTable->GetParent(pointKey); node.IsValid() && node != mGameKey; node = mTable->GetParent(node))
+	{
+		++mOwnedBelow.FindOrAdd(node);
+	}
+}
+
+void MountPointRegistry::removeOwner(MountPathId pointKey)
+{
+	Owner owner;
+	if (!mOwners.RemoveAndCopyValue(pointKey, owner)) return;
+
+	const MountPathId* owned = mFolderPoints.Find(owner.Folder);
+	if (owned && *owned == pointKey) mFolderPoints.Remove(owner.Folder);
+
+	for (MountPathId node = mTable->GetParent(pointKey); node.IsValid() && node != mGameKey; node = mTable->GetParent(node))
+	{
+		int32* count = mOwnedBelow.Find(node);
+		if (count && --(*count) <= 0) mOwnedBelow.Remove(node);
+	}
+}
+
+void MountPointRegistry::removeMounts()
+{
+	TArray<MountPathId> mounts;
+	for (const TPair<MountPathId, Owner>& owner : mOwners)
+	{
+		if (!owner.Value.bProject) mounts.Add(owner.Key);
+	}
+	for (MountPathId pointKey : mounts)
+	{
+		removeOwner(pointKey);
+	}
+}
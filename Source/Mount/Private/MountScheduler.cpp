@@ -0,0 +1,230 @@
+#include "MountScheduler.h"
+#include "AssetRegistryModule.h"
+#include "Containers/Ticker.h"
+#include "ContentBrowserModule.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+const double MountScheduler::FrameBudgetSeconds = 0.005;
+
+TSharedPtr<MountScheduler> MountScheduler::Start(const TArray<Entry>& entries, FMountRoot mountRoot)
+{
+	if (entries.Num() == 0) return nullptr;
+
+	TSharedPtr<MountScheduler> scheduler = MakeShared<MountScheduler>(entries, MoveTemp(mountRoot));
+	scheduler->start();
+	return scheduler;
+}
+
+MountScheduler::MountScheduler(const TArray<Entry>& entries, FMountRoot mountRoot)
+	: mPending(entries)
+	, mMountRoot(MoveTemp(mountRoot))
+	, mNumTotal(entries.Num())
+{
+}
+
+void MountScheduler::start()
+{
+	mStartTime = FPlatformTime::Seconds();
+
+	FContentBrowserModule& contentBrowser = FModuleManager::LoadModuleChecked<FContentBrowserModule>(TEXT("ContentBrowser"));
+	mPathChangedHandle = contentBrowser.GetOnAssetPathChanged().AddSP(this, &MountScheduler::Prioritize);
+	// Whatever asks for a package of a queued root, a map opening, an asset editor or a script, gets it
+	mSyncLoadHandle = FCoreDelegates::OnSyncLoadPackage.AddSP(this, &MountScheduler::MountNow);
+	addPlaceholders();
+
+	// Loaded after startup (hot reload, enabling the plugin), nothing to wait for
+	if (GIsRunning)
+	{
+		begin();
+	}
+	else
+	{
+		mLoopInitHandle = FCoreDelegates::OnFEngineLoopInitComplete.AddSP(this, &MountScheduler::begin);
+	}
+}
+
+void MountScheduler::begin()
+{
+	if (mLoopInitHandle.IsValid())
+	{
+		FCoreDelegates::OnFEngineLoopInitComplete.Remove(mLoopInitHandle);
+		mLoopInitHandle.Reset();
+	}
+
+	FNotificationInfo info(FText::Format(LOCTEXT("MountScheduleStart", "Mounting {0} folders"), FText::AsNumber(mNumTotal)));
+	info.bFireAndForget = false;
+	TSharedPtr<SNotificationItem> item = FSlateNotificationManager::Get().AddNotification(info);
+	if (item.IsValid())
+	{
+		item->SetCompletionState(SNotificationItem::CS_Pending);
+	}
+	mNotification = item;
+
+	TSharedRef<MountScheduler> self = AsShared();
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([self](float DeltaTime) {
+		return self->tick(DeltaTime);
+	}));
+}
+
+int32 MountScheduler::findPending(const FString& packagePath) const
+{
+	// Content browser paths may be virtual, "/All/Game/Folder/..."
+	FString path = packagePath;
+	path.RemoveFromStart(TEXT("/All"));
+	if (!path.RemoveFromStart(TEXT("/Game/"))) return INDEX_NONE;
+
+	FString folder, rest;
+	if (!path.Split(TEXT("/"), &folder, &rest))
+	{
+		folder = path;
+	}
+
+	return mPending.IndexOfByPredicate([&folder](const Entry& entry) {
+		return entry.Folders.ContainsByPredicate([&folder](const FString& mounted) { return mounted.Equals(folder, ESearchCase::IgnoreCase); });
+	});
+}
+
+void MountScheduler::Prioritize(const FString& packagePath)
+{
+	const int32 index = findPending(packagePath);
+	if (index > 0)
+	{
+		Entry entry = MoveTemp(mPending[index]);
+		mPending.RemoveAt(index);
+		mPending.Insert(MoveTemp(entry), 0);
+	}
+}
+
+void MountScheduler::Cancel()
+{
+	bCancelled = true;
+	FCoreDelegates::OnSyncLoadPackage.Remove(mSyncLoadHandle);
+	removePlaceholders();
+}
+
+void MountScheduler::MountNow(const FString& packagePath)
+{
+	// Mount points are registered on the game thread only
+	if (bCancelled || !IsInGameThread()) return;
+
+	// The load goes on once this returns, the mount point has to be there by then
+	const int32 index = findPending(packagePath);
+	if (index == INDEX_NONE) return;
+
+	const FString root = mPending[index].Root;
+	mPending.RemoveAt(index);
+	UE_LOG(LogTemp, Log, TEXT("Background mount: %s requested, mounting %s now"), *packagePath, *root);
+	mMountRoot(root);
+	++mNumMounted;
+	updateNotification(root);
+}
+
+void MountScheduler::addPlaceholders()
+{
+	IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	for (const Entry& entry : mPending)
+	{
+		for (const FString& folder : entry.Folders)
+		{
+			const FString path = TEXT("/Game/") + folder;
+			if (mPlaceholders.Contains(path)) continue;
+
+			// Project folders are there already, adding them again does nothing
+			if (assetRegistry.AddPath(path))
+			{
+				mPlaceholders.Add(path);
+			}
+		}
+	}
+}
+
+void MountScheduler::removePlaceholders()
+{
+	if (!FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry"))) return;
+
+	// Only folders of roots that were never mounted, the others hold real content by now
+	IAssetRegistry& assetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	for (const Entry& entry : mPending)
+	{
+		for (const FString& folder : entry.Folders)
+		{
+			const FString path = TEXT("/Game/") + folder;
+			if (mPlaceholders.Contains(path))
+			{
+				assetRegistry.RemovePath(path);
+			}
+		}
+	}
+	mPlaceholders.Empty();
+}
+
+void MountScheduler::Flush()
+{
+	while (!bCancelled && mPending.Num() > 0)
+	{
+		const FString root = mPending[0].Root;
+		mPending.RemoveAt(0);
+		mMountRoot(root);
+		++mNumMounted;
+	}
+	updateNotification(FString());
+}
+
+bool MountScheduler::tick(float DeltaTime)
+{
+	if (bCancelled || mPending.Num() == 0)
+	{
+		finish();
+		return false;
+	}
+
+	const double frameStart = FPlatformTime::Seconds();
+	do
+	{
+		const FString root = mPending[0].Root;
+		mPending.RemoveAt(0);
+		mMountRoot(root);
+		++mNumMounted;
+		updateNotification(root);
+	} while (mPending.Num() > 0 && FPlatformTime::Seconds() - frameStart < FrameBudgetSeconds);
+
+	return true;
+}
+
+void MountScheduler::updateNotification(const FString& root)
+{
+	TSharedPtr<SNotificationItem> item = mNotification.Pin();
+	if (!item.IsValid()) return;
+
+	item->SetText(FText::Format(LOCTEXT("MountScheduleProgress", "Mounting folders {0}/{1}: {2}"),
+		FText::AsNumber(mNumMounted), FText::AsNumber(mNumTotal), FText::FromString(root)));
+}
+
+void MountScheduler::finish()
+{
+	bFinished = true;
+
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("ContentBrowser")))
+	{
+		FModuleManager::GetModuleChecked<FContentBrowserModule>(TEXT("ContentBrowser")).GetOnAssetPathChanged().Remove(mPathChangedHandle);
+	}
+	FCoreDelegates::OnSyncLoadPackage.Remove(mSyncLoadHandle);
+	removePlaceholders();
+
+	UE_LOG(LogTemp, Log, TEXT("Background mount%s: %d/%d folders in %.1fs"), bCancelled ? TEXT(" cancelled") : TEXT(""),
+		mNumMounted, mNumTotal, FPlatformTime::Seconds() - mStartTime);
+
+	TSharedPtr<SNotificationItem> item = mNotification.Pin();
+	if (item.IsValid())
+	{
+		item->SetText(FText::Format(LOCTEXT("MountScheduleDone", "Mounted {0} folders"), FText::AsNumber(mNumMounted)));
+		item->SetCompletionState(bCancelled ? SNotificationItem::CS_Fail : SNotificationItem::CS_Success);
+		item->ExpireAndFadeout();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,199 @@
+#include "MountSignFormatter.h"
+
+namespace
+{
+	// Grown to the longest line seen on the thread, then reused
+	struct SignBuffers
+	{
+		TArray<TCHAR> Text;
+		TArray<TCHAR> SubPath;
+	};
+	thread_local SignBuffers GSignBuffers;
+
+	int32 bucketOf(TCHAR lower)
+	{
+		return (uint32)lower < 128 ? (int32)lower : 128;
+	}
+
+	void appendDigits(TArray<TCHAR>& out, int32 value, int32 width)
+	{
+		TCHAR digits[8];
+		for (int32 i = width - 1; i >= 0; --i)
+		{
+			digits[i] = TEXT('0') + value % 10;
+			value /= 10;
+		}
+		out.Append(digits, width);
+	}
+
+	void appendUTF8(TArray<uint8>& out, uint32 codepoint)
+	{
+		if (codepoint < 0x80)
+		{
+			out.Add((uint8)codepoint);
+		}
+		else if (codepoint < 0x800)
+		{
+			out.Add((uint8)(0xC0 | (codepoint >> 6)));
+			out.Add((uint8)(0x80 | (codepoint & 0x3F)));
+		}
+		else if (codepoint < 0x10000)
+		{
+			out.Add((uint8)(0xE0 | (codepoint >> 12)));
+			out.Add((uint8)(0x80 | ((codepoint >> 6) & 0x3F)));
+			out.Add((uint8)(0x80 | (codepoint & 0x3F)));
+		}
+		else
+		{
+			out.Add((uint8)(0xF0 | (codepoint >> 18)));
+			out.Add((uint8)(0x80 | ((codepoint >> 12) & 0x3F)));
+			out.Add((uint8)(0x80 | ((codepoint >> 6) & 0x3F)));
+			out.Add((uint8)(0x80 | (codepoint & 0x3F)));
+		}
+	}
+}
+
+void MountSignFormatter::SetNeedLogDirs(const TArray<FString>& needLogDirs)
+{
+	mPatternChars.Reset();
+	mPatterns.Reset();
+	for (TArray<int32>& bucket : mBuckets)
+	{
+		bucket.Reset();
+	}
+	bMatchAll = false;
+
+	for (const FString& dir : needLogDirs)
+	{
+		// FString::Contains finds an empty string in everything
+		if (dir.IsEmpty())
+		{
+			bMatchAll = true;
+			continue;
+		}
+
+		Pattern& pattern = mPatterns.AddDefaulted_GetRef();
+		pattern.Start = mPatternChars.Num();
+		pattern.Len = dir.Len();
+		for (TCHAR c : dir.GetCharArray())
+		{
+			if (c) mPatternChars.Add(FChar::ToLower(c));
+		}
+		mBuckets[bucketOf(mPatternChars[pattern.Start])].Add(mPatterns.Num() - 1);
+	}
+}
+
+void MountSignFormatter::SetHost(const FString& computer, const FString& user, const FString& ip)
+{
+	mHostText = FString::Printf(TEXT("  -  %s  -  %s  -  %s  -  "), *computer, *user, *ip);
+}
+
+bool MountSignFormatter::matchesAt(const Pattern& pattern, const TCHAR* dir, int32 dirLen, int32 offset) const
+{
+	if (offset + pattern.Len > dirLen) return false;
+
+	const TCHAR* chars = mPatternChars.GetData() + pattern.Start;
+	for (int32 i = 0; i < pattern.Len; ++i)
+	{
+		if (FChar::ToLower(dir[offset + i]) != chars[i]) return false;
+	}
+	return true;
+}
+
+bool MountSignFormatter::IsLogged(const FString& dir) const
+{
+	if (bMatchAll) return true;
+	if (mPatterns.Num() == 0) return false;
+
+	// One pass over the dir, only patterns starting with the character at hand are compared
+	const TCHAR* chars = *dir;
+	const int32 len = dir.Len();
+	for (int32 offset = 0; offset < len; ++offset)
+	{
+		for (int32 index : mBuckets[bucketOf(FChar::ToLower(chars[offset]))])
+		{
+			if (matchesAt(mPatterns[index], chars, len, offset)) return true;
+		}
+	}
+	return false;
+}
+
+FStringView MountSignFormatter::FormatText(const FDateTime& date, const FString& event) const
+{
+	// FDateTime::ToString format, "%Y.%m.%d-%H.%M.%S"
+	int32 year, month, day;
+	date.GetDate(year, month, day);
+	TArray<TCHAR>& out = GSignBuffers.Text;
+	out.Reset();
+	appendDigits(out, year, 4);
+	out.Add(TEXT('.'));
+	appendDigits(out, month, 2);
+	out.Add(TEXT('.'));
+	appendDigits(out, day, 2);
+	out.Add(TEXT('-'));
+	appendDigits(out, date.GetHour(), 2);
+	out.Add(TEXT('.'));
+	appendDigits(out, date.GetMinute(), 2);
+	out.Add(TEXT('.'));
+	appendDigits(out, date.GetSecond(), 2);
+	out.Append(*mHostText, mHostText.Len());
+	out.Append(*event, event.Len());
+	return FStringView(out.GetData(), out.Num());
+}
+
+FStringView MountSignFormatter::FormatLogSubPath(const FString& dir)
+{
+	TArray<TCHAR>& out = GSignBuffers.SubPath;
+	out.Reset();
+
+	const int32 drive = dir.Find(TEXT(":/"), ESearchCase::CaseSensitive);
+	if (drive != INDEX_NONE)
+	{
+		out.Append(*dir, drive);
+		out.Add(TEXT('/'));
+		out.Append(*dir + drive + 2, dir.Len() - drive - 2);
+	}
+	else if (dir.Find(TEXT("//"), ESearchCase::CaseSensitive) != INDEX_NONE)
+	{
+		const int32 skip = dir.StartsWith(TEXT("//"), ESearchCase::CaseSensitive) ? 2 : 0;
+		out.Append(*dir + skip, dir.Len() - skip);
+	}
+	return FStringView(out.GetData(), out.Num());
+}
+
+void MountSignFormatter::AppendString(TArray<uint8>& out, const FString& str)
+{
+	const int32 lengthOffset = out.Num();
+	out.AddUninitialized(sizeof(uint16));
+	const int32 start = out.Num();
+
+	const TCHAR* chars = *str;
+	const int32 len = str.Len();
+	for (int32 i = 0; i < len; ++i)
+	{
+		uint32 codepoint = (uint32)chars[i];
+		// TCHAR is UTF-16 on Windows
+		if (codepoint >= 0xD800 && codepoint <= 0xDBFF && i + 1 < len && (uint32)chars[i + 1] >= 0xDC00 && (uint32)chars[i + 1] <= 0xDFFF)
+		{
+			codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + ((uint32)chars[i + 1] - 0xDC00);
+			++i;
+		}
+		appendUTF8(out, codepoint);
+	}
+
+	const uint16 length = (uint16)FMath::Min(out.Num() - start, (int32)MAX_uint16);
+	out.SetNum(start + length, false);
+	FMemory::Memcpy(out.GetData() + lengthOffset, &length, sizeof(length));
+}
+
+void MountSignFormatter::AppendRecord(TArray<uint8>& out, int64 ticks, const FString& event, const FString& path)
+{
+	const int32 start = out.Num();
+	uint32 size = 0;
+	out.Append((const uint8*)&size, sizeof(size));
+	out.Append((const uint8*)&ticks, sizeof(ticks));
+	AppendString(out, event);
+	AppendString(out, path);
+	size = (uint32)(out.Num() - start - sizeof(size));
+	FMemory::Memcpy(out.GetData() + start, &size, sizeof(size));
+}
@@ -0,0 +1,178 @@
+#include "MountState.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	bool isPackagePath(const FString& path)
+	{
+		return path.StartsWith(TEXT("/")) && !path.StartsWith(TEXT("//"));
+	}
+
+	// Length of the longest prefix ending in '/' that accept() takes, the path itself counts as a folder
+	template <typename FuncType>
+	int32 findLongestPrefix(const FString& folder, FuncType accept)
+	{
+		for (int32 i = folder.Len() - 1; i > 0; --i)
+		{
+			if (folder[i] == TEXT('/') && accept(folder.Left(i + 1)))
+			{
+				return i + 1;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	FString asFolder(const FString& path)
+	{
+		FString folder = path.Replace(TEXT("\\"), TEXT("/"));
+		if (!folder.EndsWith(TEXT("/"))) folder += TEXT("/");
+		return folder;
+	}
+}
+
+MountState::MountState()
+	: mSnapshot(MakeShared<const MountStateSnapshot, ESPMode::ThreadSafe>())
+{
+}
+
+FMountStatePtr MountState::GetSnapshot() const
+{
+	FScopeLock lock(&mLock);
+	return mSnapshot;
+}
+
+void MountState::Publish(const FMountStatePtr& snapshot)
+{
+	// The old snapshot is freed by whichever reader drops it last, outside the lock
+	FMountStatePtr old;
+	{
+		FScopeLock lock(&mLock);
+		old = mSnapshot;
+		mSnapshot = snapshot;
+	}
+}
+
+bool MountState::IsPathMounted(const FString& path) const
+{
+	return IsPathMounted(*GetSnapshot(), path);
+}
+
+bool MountState::GetMountPointForPath(const FString& path, FString& outPackagePath) const
+{
+	return GetMountPointForPath(*GetSnapshot(), path, outPackagePath);
+}
+
+bool MountState::IsPathMounted(const MountStateSnapshot& snapshot, const FString& path)
+{
+	const FString folder = asFolder(path);
+	if (isPackagePath(folder))
+	{
+		return findLongestPrefix(folder, [&snapshot](const FString& prefix) { return snapshot.MountPoints.Contains(prefix); }) != INDEX_NONE;
+	}
+	return findLongestPrefix(folder, [&snapshot](const FString& prefix) { return snapshot.FolderToMountPoint.Contains(prefix); }) != INDEX_NONE;
+}
+
+bool MountState::GetMountPointForPath(const MountStateSnapshot& snapshot, const FString& path, FString& outPackagePath)
+{
+	const FString folder = asFolder(path);
+	const FString* mountPoint = nullptr;
+	const int32 len = findLongestPrefix(folder, [&snapshot, &mountPoint](const FString& prefix) {
+		mountPoint = snapshot.FolderToMountPoint.Find(prefix);
+		return mountPoint != nullptr;
+	});
+	if (len == INDEX_NONE) return false;
+
+	outPackagePath = *mountPoint + folder.Mid(len);
+	outPackagePath.RemoveFromEnd(TEXT("/"));
+	if (outPackagePath.EndsWith(FPackageName::GetAssetPackageExtension()) || outPackagePath.EndsWith(FPackageName::GetMapPackageExtension()))
+	{
+		outPackagePath = FPaths::GetBaseFilename(outPackagePath, false);
+	}
+	return true;
+}
+
+// Mount.State.Stress [Seconds] [Readers]
+// Publishes synthetic mount sets on the game thread while pool threads look paths up,
+// checks that every reader sees whole snapshots with revisions that never go back.
+static FAutoConsoleCommand GMountStateStressCommand(
+	TEXT("Mount.State.Stress"),
+	TEXT("Hammer mount state publishing and lookups concurrently. Args: [Seconds=5] [Readers=4]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const double seconds = Args.Num() > 0 ? FCString::Atod(*Args[0]) : 5.0;
+		const int32 numReaders = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 4;
+		const int32 numFolders = 512;
+
+		MountState state;
+		TAtomic<bool> bStop(false);
+		TAtomic<int64> numReads(0);
+		TAtomic<int32> numViolations(0);
+		TAtomic<uint64> maxReadCycles(0);
+
+		TArray<TFuture<void>> readers;
+		for (int32 r = 0; r < numReaders; ++r)
+		{
+			readers.Add(Async(EAsyncExecution::ThreadPool, [&, r]() {
+				FRandomStream random(r);
+				uint32 lastRevision = 0;
+				while (!bStop)
+				{
+					const int32 index = random.RandRange(0, numFolders - 1);
+					const FString file = FString::Printf(TEXT("//server/share/Lib/Folder%03d/Mesh.uasset"), index);
+					const uint64 start = FPlatformTime::Cycles64();
+					FMountStatePtr snapshot = state.GetSnapshot();
+					FString packagePath;
+					const bool bMounted = MountState::GetMountPointForPath(*snapshot, file, packagePath);
+					const uint64 cycles = FPlatformTime::Cycles64() - start;
+
+					// A folder and its mount point are published together, a torn snapshot would disagree
+					const bool bPointMounted = snapshot->MountPoints.Contains(FString::Printf(TEXT("/Game/Folder%03d/"), index));
+					if (bMounted != bPointMounted || snapshot->Revision < lastRevision || (bMounted && !packagePath.EndsWith(TEXT("/Mesh"))))
+					{
+						++numViolations;
+					}
+					lastRevision = snapshot->Revision;
+
+					uint64 prevMax = maxReadCycles.Load();
+					while (cycles > prevMax && !maxReadCycles.CompareExchange(prevMax, cycles)) {}
+					++numReads;
+				}
+			}));
+		}
+
+		// Writer: each publish toggles a random folder, built on a copy of the previous snapshot
+		FRandomStream random(numReaders);
+		int32 numPublishes = 0;
+		const double endTime = FPlatformTime::Seconds() + seconds;
+		while (FPlatformTime::Seconds() < endTime)
+		{
+			TSharedRef<MountStateSnapshot, ESPMode::ThreadSafe> next = MakeShared<MountStateSnapshot, ESPMode::ThreadSafe>(*state.GetSnapshot());
+			next->Revision++;
+			const int32 index = random.RandRange(0, numFolders - 1);
+			const FString folder = FString::Printf(TEXT("//server/share/Lib/Folder%03d/"), index);
+			const FString point = FString::Printf(TEXT("/Game/Folder%03d/"), index);
+			if (next->FolderToMountPoint.Remove(folder) > 0)
+			{
+				next->MountPoints.Remove(point);
+			}
+			else
+			{
+				next->FolderToMountPoint.Add(folder, point);
+				next->MountPoints.Add(point);
+			}
+			state.Publish(next);
+			++numPublishes;
+		}
+
+		bStop = true;
+		for (TFuture<void>& reader : readers)
+		{
+			reader.Wait();
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Mount state stress: %d publishes, %lld reads on %d threads in %.1fs, slowest read %.3f ms, %d violations"),
+			numPublishes, numReads.Load(), numReaders, seconds, FPlatformTime::ToMilliseconds64(maxReadCycles.Load()), numViolations.Load());
+	})
+);
@@ -0,0 +1,163 @@
+#include "MountTextLog.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// IPlatformFile handles and its path normalization are heap allocations, these are not
+#if !PLATFORM_WINDOWS
+	const int32 MaxPathBytes = 4096;
+
+	bool toUTF8Path(const TCHAR* path, ANSICHAR (&out)[MaxPathBytes])
+	{
+		const int32 len = FCString::Strlen(path);
+		const int32 numBytes = FTCHARToUTF8_Convert::ConvertedLength(path, len);
+		if (numBytes >= MaxPathBytes) return false;
+		FTCHARToUTF8_Convert::Convert(out, MaxPathBytes, path, len);
+		out[numBytes] = 0;
+		return true;
+	}
+#endif
+
+	bool appendToFile(const TCHAR* file, const ANSICHAR* bytes, int32 numBytes, bool bCreate)
+	{
+#if PLATFORM_WINDOWS
+		HANDLE handle = ::CreateFileW(file, FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, bCreate ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) return false;
+		DWORD written = 0;
+		const bool bWritten = ::WriteFile(handle, bytes, (DWORD)numBytes, &written, nullptr) && written == (DWORD)numBytes;
+		::CloseHandle(handle);
+		return bWritten;
+#else
+		ANSICHAR path[MaxPathBytes];
+		if (!toUTF8Path(file, path)) return false;
+		const int fd = ::open(path, O_WRONLY | O_APPEND | (bCreate ? O_CREAT : 0), 0644);
+		if (fd < 0) return false;
+		const bool bWritten = ::write(fd, bytes, numBytes) == numBytes;
+		::close(fd);
+		return bWritten;
+#endif
+	}
+
+	bool renameFile(const TCHAR* from, const TCHAR* to)
+	{
+#if PLATFORM_WINDOWS
+		return ::MoveFileExW(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		ANSICHAR fromPath[MaxPathBytes];
+		ANSICHAR toPath[MaxPathBytes];
+		return toUTF8Path(from, fromPath) && toUTF8Path(to, toPath) && ::rename(fromPath, toPath) == 0;
+#endif
+	}
+}
+
+void MountTextLog::SetRoot(const FString& root)
+{
+	mRoot = root.IsEmpty() ? root : FPaths::ConvertRelativePathToFull(root);
+	mUserName = FPlatformProcess::UserName();
+	mLogs.Empty();
+	mDirLogs.Empty();
+	mLogDirs.Empty();
+}
+
+void MountTextLog::Write(const FString& dir, FStringView subPath, FStringView line)
+{
+	if (mRoot.IsEmpty()) return;
+
+	const int32* index = mDirLogs.Find(dir);
+	if (!index)
+	{
+		const FString logDir = FPaths::Combine(mRoot, FString(subPath.Len(), subPath.GetData()));
+		index = mLogDirs.Find(logDir);
+		if (!index)
+		{
+			FolderLog& log = mLogs.AddDefaulted_GetRef();
+			log.LogDir = logDir;
+			findFile(log);
+			index = &mLogDirs.Add(logDir, mLogs.Num() - 1);
+		}
+		index = &mDirLogs.Add(dir, *index);
+	}
+
+	FolderLog& log = mLogs[*index];
+	if (!appendLine(log, line))
+	{
+		findFile(log);
+		appendLine(log, line);
+	}
+}
+
+void MountTextLog::findFile(FolderLog& log) const
+{
+	log.File.Empty();
+
+	// Find log file for me
+	IFileManager& fileMgr = IFileManager::Get();
+	TArray<FString> txtList;
+	fileMgr.FindFilesRecursive(txtList, *log.LogDir, TEXT("*.txt"), true, false, false);
+	for (const FString& txt : txtList)
+	{
+		if (txt.Contains(mUserName))
+		{
+			log.File = txt;
+			break;
+		}
+	}
+
+	if (log.File.IsEmpty())
+	{
+		fileMgr.MakeDirectory(*log.LogDir, true);
+		return;
+	}
+	TArray<FString> lines;
+	if (FFileHelper::LoadFileToStringArray(lines, *log.File))
+	{
+		FFileHelper::SaveStringArrayToFile(lines, *log.File, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	}
+}
+
+bool MountTextLog::appendLine(FolderLog& log, FStringView line)
+{
+	// <log dir>/<line>.txt
+	mNewFile.Reset();
+	mNewFile.Append(*log.LogDir, log.LogDir.Len());
+	if (mNewFile.Num() > 0 && mNewFile.Last() != TEXT('/')) mNewFile.Add(TEXT('/'));
+	mNewFile.Append(line.GetData(), line.Len());
+	mNewFile.Append(TEXT(".txt"), 4);
+	mNewFile.Add(TEXT('\0'));
+
+	const int32 lineBytes = FTCHARToUTF8_Convert::ConvertedLength(line.GetData(), line.Len());
+	const int32 terminatorLen = FCString::Strlen(LINE_TERMINATOR);
+	mBytes.SetNumUninitialized(lineBytes + terminatorLen, false);
+	FTCHARToUTF8_Convert::Convert(mBytes.GetData(), lineBytes, line.GetData(), line.Len());
+	for (int32 i = 0; i < terminatorLen; ++i)
+	{
+		mBytes[lineBytes + i] = (ANSICHAR)LINE_TERMINATOR[i];
+	}
+
+	const TCHAR* newFile = mNewFile.GetData();
+	if (log.File.IsEmpty())
+	{
+		if (!appendToFile(newFile, mBytes.GetData(), mBytes.Num(), true)) return false;
+	}
+	else
+	{
+		if (!appendToFile(*log.File, mBytes.GetData(), mBytes.Num(), false)) return false;
+		// Renamed to its latest line, a failed rename keeps the old name until the next line
+		if (!renameFile(*log.File, newFile)) return true;
+	}
+	log.File.Reset();
+	log.File.Append(newFile, mNewFile.Num() - 1);
+	return true;
+}
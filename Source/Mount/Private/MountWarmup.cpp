@@ -0,0 +1,260 @@
+#include "MountWarmup.h"
+#include "Async/Async.h"
+#include "AssetRegistryModule.h"
+#include "DirectoryWalker.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "MountCachePlatformFile.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	const int64 ReadChunkBytes = 64 * 1024;
+}
+
+MountWarmup& MountWarmup::Get()
+{
+	static TUniquePtr<MountWarmup> Singleton = MakeUnique<MountWarmup>();
+	return *Singleton;
+}
+
+MountWarmup::~MountWarmup()
+{
+	Shutdown();
+}
+
+void MountWarmup::Configure(const MountWarmupSettings& settings)
+{
+	mSettings = settings;
+	mSettings.MaxConcurrency = FMath::Max(mSettings.MaxConcurrency, 1);
+	bEnabled = true;
+	bStopping = false;
+
+	if (!mAssetAddedHandle.IsValid())
+	{
+		IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		mAssetAddedHandle = assetRegistry.OnAssetAdded().AddRaw(this, &MountWarmup::onAssetAdded);
+	}
+}
+
+void MountWarmup::Shutdown()
+{
+	bStopping = true;
+	for (TFuture<void>& worker : mWorkers)
+	{
+		worker.Wait();
+	}
+	mWorkers.Empty();
+
+	if (mAssetAddedHandle.IsValid() && FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get().OnAssetAdded().Remove(mAssetAddedHandle);
+	}
+	mAssetAddedHandle.Reset();
+	bEnabled = false;
+}
+
+void MountWarmup::Enqueue(const TArray<TPair<FString, FString>>& points)
+{
+	if (!bEnabled || points.Num() == 0) return;
+
+	{
+		FScopeLock lock(&mLock);
+		for (const TPair<FString, FString>& point : points)
+		{
+			const FString mountPoint = point.Key.EndsWith(TEXT("/")) ? point.Key : point.Key + TEXT("/");
+			mMountPoints.Add(mountPoint);
+			mPendingFolders.Emplace(mountPoint, point.Value);
+		}
+		if (mNumWorkers == 0 && mPendingFiles.Num() == 0)
+		{
+			mStartTime = FPlatformTime::Seconds();
+		}
+	}
+	startWorkers();
+}
+
+void MountWarmup::startWorkers()
+{
+	mWorkers.RemoveAll([](const TFuture<void>& worker) { return worker.IsReady(); });
+
+	FScopeLock lock(&mLock);
+	const int32 wanted = FMath::Min(mSettings.MaxConcurrency, mPendingFolders.Num() + mPendingFiles.Num());
+	while (mNumWorkers < wanted)
+	{
+		++mNumWorkers;
+		mWorkers.Add(Async(EAsyncExecution::ThreadPool, [this]() {
+			workerLoop();
+		}));
+	}
+}
+
+void MountWarmup::workerLoop()
+{
+	TArray<uint8> buffer;
+	buffer.SetNumUninitialized(ReadChunkBytes);
+	bool bLast = false;
+	while (true)
+	{
+		WarmFile file;
+		TPair<FString, FString> folder;
+		bool bHaveFile = false;
+		{
+			FScopeLock lock(&mLock);
+			if (bStopping || (mPendingFiles.Num() == 0 && mPendingFolders.Num() == 0))
+			{
+				bLast = --mNumWorkers == 0;
+				break;
+			}
+
+			// Drain headers already listed before listing more folders
+			if (mPendingFiles.Num() > 0)
+			{
+				file = mPendingFiles.Pop(false);
+				bHaveFile = true;
+			}
+			else
+			{
+				folder = mPendingFolders[0];
+				mPendingFolders.RemoveAt(0);
+			}
+		}
+
+		if (bHaveFile)
+		{
+			warmFile(file, buffer);
+		}
+		else
+		{
+			listFolder(folder);
+		}
+	}
+
+	if (bLast && !bStopping)
+	{
+		AsyncTask(ENamedThreads::GameThread, [this]() {
+			LogStats();
+		});
+	}
+}
+
+void MountWarmup::listFolder(const TPair<FString, FString>& point)
+{
+	FString folder = point.Value;
+	FPaths::NormalizeDirectoryName(folder);
+
+	TArray<DirectoryEntry> entries;
+	DirectoryWalker().ListRecursive(folder, entries);
+
+	TArray<WarmFile> files;
+	const FString assetExtension = FPackageName::GetAssetPackageExtension();
+	const FString mapExtension = FPackageName::GetMapPackageExtension();
+	for (const DirectoryEntry& entry : entries)
+	{
+		if (entry.bIsDirectory || !(entry.Path.EndsWith(assetExtension) || entry.Path.EndsWith(mapExtension))) continue;
+
+		// The package name follows from the mount point, no lookup in the engine's mount table
+		FString relative = entry.Path.Mid(folder.Len());
+		relative.RemoveFromStart(TEXT("/"));
+		WarmFile& file = files.AddDefaulted_GetRef();
+		file.File = entry.Path;
+		file.PackageName = FName(*(point.Key + FPaths::GetBaseFilename(relative, false)));
+	}
+
+	FScopeLock lock(&mLock);
+	mPendingFiles.Append(MoveTemp(files));
+}
+
+void MountWarmup::warmFile(const WarmFile& file, TArray<uint8>& buffer)
+{
+	// Through the mount cache a miss copies the whole package, none of it counted against the bucket,
+	// so headers are read from the layer below it
+	IPlatformFile* platformFile = &FPlatformFileManager::Get().GetPlatformFile();
+	if (MountCachePlatformFile* cache = MountCachePlatformFile::Get())
+	{
+		platformFile = cache->GetLowerLevel();
+	}
+	TUniquePtr<IFileHandle> handle(platformFile->OpenRead(*file.File));
+	if (!handle) return;
+
+	int64 remaining = FMath::Min(handle->Size(), mSettings.HeaderBytes);
+	while (remaining > 0 && !bStopping)
+	{
+		const int64 chunk = FMath::Min(remaining, ReadChunkBytes);
+		acquireBandwidth(chunk);
+		if (!handle->Read(buffer.GetData(), chunk)) break;
+		remaining -= chunk;
+		mBytesWarmed += chunk;
+	}
+
+	++mNumWarmed;
+	FScopeLock lock(&mLock);
+	mWarmPackages.Add(file.PackageName);
+}
+
+void MountWarmup::acquireBandwidth(int64 bytes)
+{
+	if (mSettings.MaxBytesPerSecond <= 0) return;
+
+	const double rate = (double)mSettings.MaxBytesPerSecond;
+	while (!bStopping)
+	{
+		double wait = 0.0;
+		{
+			FScopeLock lock(&mBucketLock);
+			const double now = FPlatformTime::Seconds();
+			// At most one second worth of burst
+			mBucketTokens = FMath::Min(mBucketTokens + (now - mBucketTime) * rate, rate);
+			mBucketTime = now;
+			if (mBucketTokens > 0.0)
+			{
+				mBucketTokens -= bytes;
+				return;
+			}
+			wait = -mBucketTokens / rate;
+		}
+		FPlatformProcess::Sleep(FMath::Clamp(wait, 0.001, 0.05));
+	}
+}
+
+bool MountWarmup::isUnderWarmedMount(const FString& packageName) const
+{
+	for (int32 i = packageName.Len() - 1; i > 0; --i)
+	{
+		if (packageName[i] == TEXT('/') && mMountPoints.Contains(packageName.Left(i + 1)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void MountWarmup::onAssetAdded(const FAssetData& asset)
+{
+	FScopeLock lock(&mLock);
+	if (mMountPoints.Num() == 0 || !isUnderWarmedMount(asset.PackageName.ToString())) return;
+
+	++mNumDiscovered;
+	if (mWarmPackages.Contains(asset.PackageName))
+	{
+		++mNumDiscoveredWarm;
+	}
+}
+
+void MountWarmup::LogStats() const
+{
+	FScopeLock lock(&mLock);
+	const double seconds = FPlatformTime::Seconds() - mStartTime;
+	UE_LOG(LogTemp, Log, TEXT("Mount warm-up: %d headers, %.1f MB in %.1fs, %d files queued. Registry found %d assets under warmed mounts, %d (%.1f%%) warm"),
+		mNumWarmed.Load(), mBytesWarmed.Load() / (1024.0 * 1024.0), seconds, mPendingFiles.Num(),
+		mNumDiscovered, mNumDiscoveredWarm, mNumDiscovered > 0 ? 100.0 * mNumDiscoveredWarm / mNumDiscovered : 0.0);
+}
+
+static FAutoConsoleCommand GMountWarmupStatsCommand(
+	TEXT("Mount.Warmup.Stats"),
+	TEXT("Log package header warm-up progress and how much of the registry scan found warm headers"),
+	FConsoleCommandDelegate::CreateLambda([]() {
+		MountWarmup::Get().LogStats();
+	})
+);
@@ -0,0 +1,108 @@
+#include "PackageImportReader.h"
+#include "HAL/FileManager.h"
+#include "Serialization/ArchiveProxy.h"
+#include "UObject/ObjectResource.h"
+#include "UObject/ObjectVersion.h"
+#include "UObject/PackageFileSummary.h"
+
+namespace
+{
+	// Names in the import table are indices into the name table, as FLinkerLoad reads them
+	class NameTableArchive : public FArchiveProxy
+	{
+	public:
+		NameTableArchive(FArchive& inner, const TArray<FName>& names)
+			: FArchiveProxy(inner)
+			, mNames(names)
+		{
+		}
+
+		virtual FArchive& operator<<(FName& name) override
+		{
+			int32 index = 0;
+			int32 number = 0;
+			InnerArchive << index << number;
+			if (!mNames.IsValidIndex(index))
+			{
+				SetError();
+				name = NAME_None;
+				return *this;
+			}
+			name = FName(mNames[index], number);
+			return *this;
+		}
+
+	private:
+		const TArray<FName>& mNames;
+	};
+}
+
+bool PackageImportReader::ReadImportedPackages(const FString& fileName, TArray<FName>& outPackages, TArray<FName>* outSoftPackages)
+{
+	TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*fileName, FILEREAD_Silent));
+	if (!reader) return false;
+
+	FPackageFileSummary summary;
+	*reader << summary;
+	if (reader->IsError() || summary.Tag != PACKAGE_FILE_TAG || summary.NameCount < 0 || summary.ImportCount < 0)
+	{
+		return false;
+	}
+
+	// The layout of names and imports depends on the versions the package was saved with
+	reader->SetUE4Ver(summary.GetFileVersionUE4());
+	reader->SetLicenseeUE4Ver(summary.GetFileVersionLicenseeUE4());
+	reader->SetEngineVer(summary.SavedByEngineVersion);
+	reader->SetCustomVersions(summary.GetCustomVersionContainer());
+	reader->SetFilterEditorOnly((summary.PackageFlags & PKG_FilterEditorOnly) != 0);
+
+	TArray<FName> names;
+	names.Reserve(summary.NameCount);
+	reader->Seek(summary.NameOffset);
+	for (int32 i = 0; i < summary.NameCount && !reader->IsError(); ++i)
+	{
+		FNameEntrySerialized entry(ENAME_LinkerConstructor);
+		*reader << entry;
+		names.Add(FName(entry));
+	}
+	if (reader->IsError()) return false;
+
+	// Created after the versions are set, the proxy copies them
+	NameTableArchive importReader(*reader, names);
+	reader->Seek(summary.ImportOffset);
+	for (int32 i = 0; i < summary.ImportCount; ++i)
+	{
+		FObjectImport import;
+		importReader << import;
+		if (importReader.IsError() || reader->IsError()) return false;
+
+		// Top level imports are the packages themselves
+		if (import.OuterIndex.IsNull() && import.ClassName == NAME_Package)
+		{
+			outPackages.Add(import.ObjectName);
+		}
+	}
+
+	// Read the way FLinkerLoad::SerializeSoftPackageReferenceList does
+	if (outSoftPackages && summary.SoftPackageReferencesCount > 0 && reader->UE4Ver() >= VER_UE4_ADD_STRING_ASSET_REFERENCES_MAP)
+	{
+		reader->Seek(summary.SoftPackageReferencesOffset);
+		for (int32 i = 0; i < summary.SoftPackageReferencesCount; ++i)
+		{
+			if (reader->UE4Ver() < VER_UE4_ADDED_SOFT_OBJECT_PATH)
+			{
+				FString packageName;
+				*reader << packageName;
+				outSoftPackages->Add(FName(*packageName));
+			}
+			else
+			{
+				FName packageName;
+				importReader << packageName;
+				outSoftPackages->Add(packageName);
+			}
+			if (importReader.IsError() || reader->IsError()) return false;
+		}
+	}
+	return true;
+}
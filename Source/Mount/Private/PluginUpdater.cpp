@@ -0,0 +1,528 @@
+#include "PluginUpdater.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "AtomicFile.h"
+#include "DirectoryWalker.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Utilities.h"
+
+const TCHAR* PluginUpdater::ManifestName = TEXT("manifest.json");
+
+namespace
+{
+	const int64 HashBufferBytes = 1024 * 1024;
+	const TCHAR* PendingName = TEXT("pending.json");
+	// The manifest of the version in place, staged with pending.json and kept in Saved/Update once applied
+	const TCHAR* InstalledName = TEXT("installed.json");
+
+	struct CachedHash
+	{
+		int64 Size = 0;
+		int64 ModifiedTicks = 0;
+		FString Hash;
+	};
+
+	FString hashFile(const FString& file, const TAtomic<bool>* bCancel = nullptr)
+	{
+		TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*file, FILEREAD_Silent));
+		if (!reader) return FString();
+
+		TArray<uint8> buffer;
+		buffer.SetNumUninitialized(HashBufferBytes);
+		FSHA1 hasher;
+		int64 remaining = reader->TotalSize();
+		while (remaining > 0)
+		{
+			if (bCancel && bCancel->Load()) return FString();
+			const int64 read = FMath::Min(remaining, HashBufferBytes);
+			reader->Serialize(buffer.GetData(), read);
+			if (reader->IsError()) return FString();
+			hasher.Update(buffer.GetData(), read);
+			remaining -= read;
+		}
+		hasher.Final();
+		FSHAHash hash;
+		hasher.GetHash(hash.Hash);
+		return hash.ToString();
+	}
+
+	// The manifest comes from a share, nothing in it may point outside the plugin folder
+	bool isSafeRelativePath(const FString& path)
+	{
+		return !path.IsEmpty() && FPaths::IsRelative(path) && !path.Contains(TEXT("..")) && !path.Contains(TEXT(":"));
+	}
+
+	// Local state of an install, never published and never removed by an update
+	bool isLocalState(const FString& path)
+	{
+		return path.StartsWith(TEXT("Saved/")) || path.StartsWith(TEXT("Intermediate/")) || path.Equals(PluginUpdater::ManifestName) || path.EndsWith(TEXT(".old"));
+	}
+
+	bool loadJson(const FString& file, TSharedPtr<FJsonObject>& outRoot)
+	{
+		FString json;
+		return FFileHelper::LoadFileToString(json, *file, FILEREAD_Silent)
+			&& FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), outRoot) && outRoot.IsValid();
+	}
+
+	bool saveJson(const TSharedRef<FJsonObject>& root, const FString& file)
+	{
+		FString json;
+		TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+		FJsonSerializer::Serialize(root, writer);
+
+		return AtomicFile::SaveStringToFile(json, file);
+	}
+
+	// Removed is only written to pending.json
+	bool loadManifest(const FString& file, FString& outVersion, TArray<PluginUpdateFile>& outFiles, TArray<FString>* outRemoved = nullptr)
+	{
+		TSharedPtr<FJsonObject> root;
+		const TArray<TSharedPtr<FJsonValue>>* files = nullptr;
+		if (!loadJson(file, root) || !root->TryGetArrayField(TEXT("Files"), files)) return false;
+
+		root->TryGetStringField(TEXT("Version"), outVersion);
+		if (outRemoved) root->TryGetStringArrayField(TEXT("Removed"), *outRemoved);
+		for (const TSharedPtr<FJsonValue>& value : *files)
+		{
+			const TSharedPtr<FJsonObject>* object = nullptr;
+			if (!value->TryGetObject(object)) continue;
+
+			PluginUpdateFile& entry = outFiles.AddDefaulted_GetRef();
+			FString size;
+			(*object)->TryGetStringField(TEXT("Path"), entry.Path);
+			(*object)->TryGetStringField(TEXT("Size"), size);
+			(*object)->TryGetStringField(TEXT("Hash"), entry.Hash);
+			LexFromString(entry.Size, *size);
+		}
+		return true;
+	}
+
+	bool saveManifest(const FString& file, const FString& version, const TArray<PluginUpdateFile>& files, const TArray<FString>& removed = TArray<FString>())
+	{
+		TArray<TSharedPtr<FJsonValue>> values;
+		for (const PluginUpdateFile& entry : files)
+		{
+			TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+			object->SetStringField(TEXT("Path"), entry.Path);
+			// 64 bit values as strings, JSON numbers are doubles
+			object->SetStringField(TEXT("Size"), LexToString(entry.Size));
+			object->SetStringField(TEXT("Hash"), entry.Hash);
+			values.Add(MakeShared<FJsonValueObject>(object));
+		}
+
+		TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+		root->SetStringField(TEXT("Version"), version);
+		root->SetArrayField(TEXT("Files"), values);
+		if (removed.Num() > 0)
+		{
+			TArray<TSharedPtr<FJsonValue>> removedValues;
+			for (const FString& path : removed)
+			{
+				removedValues.Add(MakeShared<FJsonValueString>(path));
+			}
+			root->SetArrayField(TEXT("Removed"), removedValues);
+		}
+		return saveJson(root, file);
+	}
+
+	void loadHashCache(const FString& file, TMap<FString, CachedHash>& outCache)
+	{
+		TSharedPtr<FJsonObject> root;
+		const TArray<TSharedPtr<FJsonValue>>* files = nullptr;
+		if (!loadJson(file, root) || !root->TryGetArrayField(TEXT("Files"), files)) return;
+
+		for (const TSharedPtr<FJsonValue>& value : *files)
+		{
+			const TSharedPtr<FJsonObject>* object = nullptr;
+			if (!value->TryGetObject(object)) continue;
+
+			FString path, size, modified;
+			CachedHash entry;
+			(*object)->TryGetStringField(TEXT("Path"), path);
+			(*object)->TryGetStringField(TEXT("Size"), size);
+			(*object)->TryGetStringField(TEXT("Modified"), modified);
+			(*object)->TryGetStringField(TEXT("Hash"), entry.Hash);
+			LexFromString(entry.Size, *size);
+			LexFromString(entry.ModifiedTicks, *modified);
+			outCache.Add(path, entry);
+		}
+	}
+
+	void saveHashCache(const FString& file, const TMap<FString, CachedHash>& cache)
+	{
+		TArray<TSharedPtr<FJsonValue>> values;
+		for (const TPair<FString, CachedHash>& pair : cache)
+		{
+			TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+			object->SetStringField(TEXT("Path"), pair.Key);
+			object->SetStringField(TEXT("Size"), LexToString(pair.Value.Size));
+			object->SetStringField(TEXT("Modified"), LexToString(pair.Value.ModifiedTicks));
+			object->SetStringField(TEXT("Hash"), pair.Value.Hash);
+			values.Add(MakeShared<FJsonValueObject>(object));
+		}
+
+		TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+		root->SetArrayField(TEXT("Files"), values);
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(file), true);
+		saveJson(root, file);
+	}
+}
+
+PluginUpdater& PluginUpdater::Get()
+{
+	static TUniquePtr<PluginUpdater> Singleton = MakeUnique<PluginUpdater>();
+	return *Singleton;
+}
+
+PluginUpdater::~PluginUpdater()
+{
+	Cancel();
+}
+
+FString PluginUpdater::GetStagingDir(const FString& pluginDir)
+{
+	// Same volume as the plugin, so applying is renames only
+	return pluginDir / TEXT("Saved") / TEXT("Update") / TEXT("Staging");
+}
+
+void PluginUpdater::CheckAsync(const FString& sourceDir, const FString& pluginDir, TFunction<void(const PluginUpdateResult&)> onComplete)
+{
+	if (IsChecking()) return;
+
+	bCancel = false;
+	mCheck = Async(EAsyncExecution::ThreadPool, [this, sourceDir, pluginDir, onComplete]() {
+		const PluginUpdateResult result = check(sourceDir, pluginDir);
+		AsyncTask(ENamedThreads::GameThread, [result, onComplete]() {
+			if (onComplete) onComplete(result);
+		});
+	});
+}
+
+void PluginUpdater::Cancel()
+{
+	bCancel = true;
+	if (mCheck.IsValid())
+	{
+		mCheck.Wait();
+		mCheck = TFuture<void>();
+	}
+	if (mCleanup.IsValid())
+	{
+		mCleanup.Wait();
+		mCleanup = TFuture<void>();
+	}
+}
+
+PluginUpdateResult PluginUpdater::check(const FString& sourceDir, const FString& pluginDir)
+{
+	PluginUpdateResult result;
+	const double startTime = FPlatformTime::Seconds();
+	TArray<PluginUpdateFile> remote;
+	if (!loadManifest(sourceDir / ManifestName, result.Version, remote))
+	{
+		result.Error = FString::Printf(TEXT("no %s in %s"), ManifestName, *sourceDir);
+		return result;
+	}
+	result.NumFiles = remote.Num();
+
+	// Installed files are hashed only when their size or mtime changed since the last check
+	const FString stagingDir = GetStagingDir(pluginDir);
+	const FString cachePath = FPaths::GetPath(stagingDir) / TEXT("LocalHashes.json");
+	TMap<FString, CachedHash> cache;
+	loadHashCache(cachePath, cache);
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TArray<const PluginUpdateFile*> changed;
+	for (const PluginUpdateFile& file : remote)
+	{
+		if (bCancel)
+		{
+			result.Error = TEXT("cancelled");
+			return result;
+		}
+		if (!isSafeRelativePath(file.Path))
+		{
+			result.Error = FString::Printf(TEXT("manifest entry %s is outside the plugin"), *file.Path);
+			return result;
+		}
+
+		const FFileStatData stat = platformFile.GetStatData(*(pluginDir / file.Path));
+		if (!stat.bIsValid || stat.FileSize != file.Size)
+		{
+			changed.Add(&file);
+			continue;
+		}
+
+		CachedHash& cached = cache.FindOrAdd(file.Path);
+		const int64 modifiedTicks = stat.ModificationTime.GetTicks();
+		if (cached.Hash.IsEmpty() || cached.Size != stat.FileSize || cached.ModifiedTicks != modifiedTicks)
+		{
+			cached.Size = stat.FileSize;
+			cached.ModifiedTicks = modifiedTicks;
+			cached.Hash = hashFile(pluginDir / file.Path, &bCancel);
+		}
+		if (!cached.Hash.Equals(file.Hash, ESearchCase::IgnoreCase))
+		{
+			changed.Add(&file);
+		}
+	}
+	saveHashCache(cachePath, cache);
+	result.NumChanged = changed.Num();
+
+	// Files the installed version shipped and the new one dropped, a stale module binary or source breaks
+	// the next build or load. Only what an earlier manifest listed, never local builds or settings. An
+	// install copied from a published folder has that folder's manifest.json.
+	const FString installedPath = FPaths::GetPath(stagingDir) / InstalledName;
+	FString installedVersion;
+	TArray<PluginUpdateFile> installed;
+	if (!loadManifest(installedPath, installedVersion, installed))
+	{
+		loadManifest(pluginDir / ManifestName, installedVersion, installed);
+	}
+	TSet<FString> remotePaths;
+	for (const PluginUpdateFile& file : remote)
+	{
+		remotePaths.Add(file.Path);
+	}
+	TArray<FString> removed;
+	for (const PluginUpdateFile& file : installed)
+	{
+		if (isSafeRelativePath(file.Path) && !remotePaths.Contains(file.Path) && platformFile.FileExists(*(pluginDir / file.Path)))
+		{
+			removed.Add(file.Path);
+		}
+	}
+	result.NumRemoved = removed.Num();
+
+	// Whatever was staged before belongs to an older manifest until its files are checked again below
+	const FString pendingPath = stagingDir / PendingName;
+	platformFile.DeleteFile(*pendingPath);
+	if (changed.Num() == 0 && removed.Num() == 0)
+	{
+		IFileManager::Get().DeleteDirectory(*stagingDir, false, true);
+		// Up to date, the next check diffs against this version
+		saveManifest(installedPath, result.Version, remote);
+		result.bSuccess = true;
+		result.Seconds = FPlatformTime::Seconds() - startTime;
+		return result;
+	}
+
+	TArray<PluginUpdateFile> staged;
+	for (const PluginUpdateFile* file : changed)
+	{
+		if (bCancel)
+		{
+			result.Error = TEXT("cancelled");
+			return result;
+		}
+
+		// Staged by an earlier check that was never applied
+		const FString target = stagingDir / file->Path;
+		if (platformFile.FileSize(*target) == file->Size && hashFile(target, &bCancel).Equals(file->Hash, ESearchCase::IgnoreCase))
+		{
+			staged.Add(*file);
+			continue;
+		}
+
+		// The source can be republished while we copy, only a copy matching the manifest is staged
+		const FString tempFile = target + TEXT(".tmp");
+		platformFile.CreateDirectoryTree(*FPaths::GetPath(target));
+		if (!platformFile.CopyFile(*tempFile, *(sourceDir / file->Path)) || !hashFile(tempFile, &bCancel).Equals(file->Hash, ESearchCase::IgnoreCase))
+		{
+			platformFile.DeleteFile(*tempFile);
+			result.Error = FString::Printf(TEXT("failed to copy %s"), *file->Path);
+			return result;
+		}
+		platformFile.DeleteFile(*target);
+		if (!platformFile.MoveFile(*target, *tempFile))
+		{
+			platformFile.DeleteFile(*tempFile);
+			result.Error = FString::Printf(TEXT("failed to stage %s"), *file->Path);
+			return result;
+		}
+		result.CopiedBytes += file->Size;
+		staged.Add(*file);
+	}
+
+	// Written last, ApplyStaged ignores a staging folder without it
+	platformFile.CreateDirectoryTree(*stagingDir);
+	if (!saveManifest(stagingDir / InstalledName, result.Version, remote) || !saveManifest(pendingPath, result.Version, staged, removed))
+	{
+		result.Error = FString::Printf(TEXT("failed to write %s"), *pendingPath);
+		return result;
+	}
+	result.bSuccess = true;
+	result.Seconds = FPlatformTime::Seconds() - startTime;
+	return result;
+}
+
+bool PluginUpdater::ApplyStaged(const FString& pluginDir)
+{
+	const FString stagingDir = GetStagingDir(pluginDir);
+	FString version;
+	TArray<PluginUpdateFile> files;
+	TArray<FString> removed;
+	if (!loadManifest(stagingDir / PendingName, version, files, &removed)) return true;
+
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	// Target - kept original, empty if the file is new
+	TArray<TPair<FString, FString>> swapped;
+	bool bSuccess = true;
+	for (const PluginUpdateFile& file : files)
+	{
+		const FString staged = stagingDir / file.Path;
+		const FString target = pluginDir / file.Path;
+		if (!isSafeRelativePath(file.Path) || platformFile.FileSize(*staged) != file.Size)
+		{
+			bSuccess = false;
+			break;
+		}
+
+		// Loaded binaries can be renamed but not overwritten or deleted
+		FString old;
+		if (platformFile.FileExists(*target))
+		{
+			old = target + TEXT(".old");
+			platformFile.DeleteFile(*old);
+			if (!platformFile.MoveFile(*old, *target))
+			{
+				bSuccess = false;
+				break;
+			}
+		}
+		platformFile.CreateDirectoryTree(*FPaths::GetPath(target));
+		if (!platformFile.MoveFile(*target, *staged))
+		{
+			if (!old.IsEmpty()) platformFile.MoveFile(*target, *old);
+			bSuccess = false;
+			break;
+		}
+		swapped.Emplace(target, old);
+	}
+
+	// Dropped files go aside like replaced ones, CleanupOldFiles deletes them
+	int32 numRemoved = 0;
+	for (int32 i = 0; bSuccess && i < removed.Num(); ++i)
+	{
+		const FString target = pluginDir / removed[i];
+		if (!isSafeRelativePath(removed[i]))
+		{
+			bSuccess = false;
+			break;
+		}
+		if (!platformFile.FileExists(*target)) continue;
+
+		const FString old = target + TEXT(".old");
+		platformFile.DeleteFile(*old);
+		if (!platformFile.MoveFile(*old, *target))
+		{
+			bSuccess = false;
+			break;
+		}
+		swapped.Emplace(target, old);
+		++numRemoved;
+	}
+
+	if (!bSuccess)
+	{
+		// Back to the installed version, the staged files that were moved are copied again by the next check
+		for (int32 i = swapped.Num() - 1; i >= 0; --i)
+		{
+			platformFile.DeleteFile(*swapped[i].Key);
+			if (!swapped[i].Value.IsEmpty()) platformFile.MoveFile(*swapped[i].Key, *swapped[i].Value);
+		}
+		IFileManager::Get().Delete(*(stagingDir / PendingName));
+		UE_LOG(LogTemp, Error, TEXT("Mount plugin update %s could not be applied, kept the installed version"), *version);
+		return false;
+	}
+
+	// What the next check diffs against. Should this fail it diffs against the older manifest, files
+	// removed here are then skipped as missing.
+	AtomicFile::Replace(FPaths::GetPath(stagingDir) / InstalledName, stagingDir / InstalledName);
+	IFileManager::Get().DeleteDirectory(*stagingDir, false, true);
+	UE_LOG(LogTemp, Log, TEXT("Mount plugin updated to %s, %d files replaced, %d removed"), *version, swapped.Num() - numRemoved, numRemoved);
+	return true;
+}
+
+void PluginUpdater::CleanupOldFiles(const FString& pluginDir)
+{
+	mCleanup = Async(EAsyncExecution::ThreadPool, [pluginDir]() {
+		TArray<FString> oldFiles;
+		IFileManager::Get().FindFilesRecursive(oldFiles, *pluginDir, TEXT("*.old"), true, false, false);
+		int32 numDeleted = 0;
+		for (const FString& file : oldFiles)
+		{
+			// Still held if another editor runs from the same install, next start gets it
+			numDeleted += IFileManager::Get().Delete(*file, false, true, true) ? 1 : 0;
+		}
+		UE_CLOG(oldFiles.Num() > 0, LogTemp, Log, TEXT("Mount plugin update: deleted %d of %d replaced files"), numDeleted, oldFiles.Num());
+	});
+}
+
+bool PluginUpdater::WriteManifest(const FString& dir, const FString& version)
+{
+	FString root = dir;
+	FPaths::NormalizeDirectoryName(root);
+	TArray<DirectoryEntry> entries;
+	if (!DirectoryWalker().ListRecursive(root, entries)) return false;
+
+	TArray<PluginUpdateFile> files;
+	for (const DirectoryEntry& entry : entries)
+	{
+		if (entry.bIsDirectory) continue;
+
+		// Local state of an install, never published
+		const FString path = entry.Path.Mid(root.Len() + 1);
+		if (isLocalState(path)) continue;
+
+		PluginUpdateFile& file = files.AddDefaulted_GetRef();
+		file.Path = path;
+		file.Size = entry.Size;
+	}
+	ParallelFor(files.Num(), [&](int32 index) {
+		files[index].Hash = hashFile(root / files[index].Path);
+	});
+
+	const bool bSaved = saveManifest(root / ManifestName, version, files);
+	UE_LOG(LogTemp, Log, TEXT("Mount plugin manifest %s: %d files%s"), *version, files.Num(), bSaved ? TEXT("") : TEXT(", failed to write"));
+	return bSaved;
+}
+
+// Mount.Update.Check <SourceDir>
+static FAutoConsoleCommand GMountUpdateCheckCommand(
+	TEXT("Mount.Update.Check"),
+	TEXT("Stage a plugin update from a published folder now, applied when the editor closes. Args: <SourceDir>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 1)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.Update.Check <SourceDir>"));
+			return;
+		}
+		PluginUpdater::Get().CheckAsync(Args[0], Utilities::Get().GetPluginPath(), [](const PluginUpdateResult& result) {
+			UE_LOG(LogTemp, Log, TEXT("Mount plugin update %s: %s, %d of %d files differ, %d removed, %.1f KB copied in %.1fs"), *result.Version,
+				result.bSuccess ? TEXT("staged") : *result.Error, result.NumChanged, result.NumFiles, result.NumRemoved, result.CopiedBytes / 1024.0, result.Seconds);
+		});
+	})
+);
+
+// Mount.Update.Publish <PluginDir> <Version>
+static FAutoConsoleCommand GMountUpdatePublishCommand(
+	TEXT("Mount.Update.Publish"),
+	TEXT("Write the manifest.json that makes a plugin folder an update source. Args: <PluginDir> <Version>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 2)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.Update.Publish <PluginDir> <Version>"));
+			return;
+		}
+		PluginUpdater::WriteManifest(Args[0], Args[1]);
+	})
+);
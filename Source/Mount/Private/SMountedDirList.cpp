@@ -0,0 +1,98 @@
+#include "SMountedDirList.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+
+void SMountedDirList::Construct(const FArguments& InArgs)
+{
+	mItems = InArgs._Items.IsValid() ? InArgs._Items : MakeShared<const FMountDataList>();
+	mOnItemClicked = InArgs._OnItemClicked;
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(4.f)
+		[
+			SNew(SSearchBox)
+			.HintText(LOCTEXT("FilterMounted", "Filter mounted folders"))
+			.OnTextChanged(this, &SMountedDirList::onFilterTextChanged)
+		]
+		+ SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			SNew(SBox)
+			.MinDesiredWidth(360.f)
+			.MaxDesiredHeight(480.f)
+			[
+				SAssignNew(mListView, SListView<FMountDataPtr>)
+				.ListItemsSource(mItems.Get())
+				.SelectionMode(ESelectionMode::None)
+				.OnGenerateRow(this, &SMountedDirList::onGenerateRow)
+				.OnMouseButtonClick(this, &SMountedDirList::onItemClicked)
+			]
+		]
+	];
+}
+
+TSharedRef<ITableRow> SMountedDirList::onGenerateRow(FMountDataPtr item, const TSharedRef<STableViewBase>& ownerTable)
+{
+	return SNew(STableRow<FMountDataPtr>, ownerTable)
+		.Padding(FMargin(6.f, 2.f))
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString(item->RootDir))
+			.ToolTipText(FText::FromString(FString::Join(item->SubDirs, TEXT("\n"))))
+			.HighlightText_Lambda([this]() { return FText::FromString(mFilterText); })
+		];
+}
+
+void SMountedDirList::onFilterTextChanged(const FText& text)
+{
+	const FString filter = text.ToString().TrimStartAndEnd();
+	if (filter.IsEmpty())
+	{
+		mFilterText.Empty();
+		mListView->SetItemsSource(mItems.Get());
+		mListView->RequestListRefresh();
+		return;
+	}
+
+	// Typing more characters can only narrow the result, so filter what is already shown
+	const bool bNarrowing = !mFilterText.IsEmpty() && filter.StartsWith(mFilterText);
+	FMountDataList source;
+	if (bNarrowing)
+	{
+		source = MoveTemp(mFiltered);
+	}
+	else
+	{
+		source = *mItems;
+	}
+	mFiltered.Reset();
+	for (const FMountDataPtr& item : source)
+	{
+		if (item->RootDir.Contains(filter))
+		{
+			mFiltered.Add(item);
+		}
+	}
+
+	mFilterText = filter;
+	mListView->SetItemsSource(&mFiltered);
+	mListView->RequestListRefresh();
+}
+
+void SMountedDirList::onItemClicked(FMountDataPtr item)
+{
+	if (!item.IsValid()) return;
+
+	FSlateApplication::Get().DismissAllMenus();
+	mOnItemClicked.ExecuteIfBound(*item);
+}
+
+#undef LOCTEXT_NAMESPACE
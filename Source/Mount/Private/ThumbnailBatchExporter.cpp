@@ -0,0 +1,319 @@
+#include "ThumbnailBatchExporter.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "AssetRegistryModule.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+#include "ObjectTools.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+const TCHAR* ThumbnailBatchExporter::ManifestName = TEXT("ThumbnailManifest.json");
+
+TSharedPtr<ThumbnailBatchExporter> ThumbnailBatchExporter::ExportMountRoot(const FString& mountRoot, const ThumbnailExportSettings& settings)
+{
+	// Accept both "/Game/Lib" and the mounted directory on disk
+	FString packagePath = mountRoot;
+	if (!FPackageName::IsValidPath(packagePath))
+	{
+		FString dir = FPaths::ConvertRelativePathToFull(mountRoot) / TEXT("");
+		if (!FPackageName::TryConvertFilenameToLongPackageName(dir, packagePath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Thumbnail export: %s is not mounted"), *mountRoot);
+			return nullptr;
+		}
+	}
+	packagePath.RemoveFromEnd(TEXT("/"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.ScanPathsSynchronous({ packagePath });
+
+	TArray<FAssetData> assets;
+	AssetRegistry.GetAssetsByPath(FName(*packagePath), assets, true);
+	return ExportAssets(assets, settings);
+}
+
+TSharedPtr<ThumbnailBatchExporter> ThumbnailBatchExporter::ExportAssets(const TArray<FAssetData>& assets, const ThumbnailExportSettings& settings)
+{
+	TSharedPtr<ThumbnailBatchExporter> exporter = MakeShared<ThumbnailBatchExporter>(assets, settings);
+	exporter->start();
+	return exporter;
+}
+
+ThumbnailBatchExporter::ThumbnailBatchExporter(const TArray<FAssetData>& assets, const ThumbnailExportSettings& settings)
+	: mSettings(settings)
+{
+	mAssets.Reserve(assets.Num());
+	for (const FAssetData& asset : assets)
+	{
+		// Redirectors have nothing to render
+		if (asset.IsValid() && !asset.IsRedirector())
+		{
+			mAssets.Add(asset);
+		}
+	}
+}
+
+ThumbnailBatchExporter::~ThumbnailBatchExporter()
+{
+	bCancelled = true;
+	if (mHashTask.IsValid())
+	{
+		mHashTask.Wait();
+	}
+}
+
+void ThumbnailBatchExporter::start()
+{
+	mStartTime = FPlatformTime::Seconds();
+	loadManifest();
+
+	// Package name -> filename needs the mount point table, resolve it here on the game thread
+	const FName worldClass = UWorld::StaticClass()->GetFName();
+	mFilenames.SetNum(mAssets.Num());
+	mHashes.SetNum(mAssets.Num());
+	for (int32 i = 0; i < mAssets.Num(); ++i)
+	{
+		const FString& extension = mAssets[i].AssetClass == worldClass ? FPackageName::GetMapPackageExtension() : FPackageName::GetAssetPackageExtension();
+		FPackageName::TryConvertLongPackageNameToFilename(mAssets[i].PackageName.ToString(), mFilenames[i], extension);
+	}
+
+	mHashTask = Async(EAsyncExecution::ThreadPool, [this]() {
+		hashPackages();
+		bHashed = true;
+	});
+
+	// The ticker keeps us alive until every pending write has landed
+	TSharedRef<ThumbnailBatchExporter> self = AsShared();
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([self](float DeltaTime) {
+		return self->tick(DeltaTime);
+	}));
+}
+
+void ThumbnailBatchExporter::hashPackages()
+{
+	ParallelFor(mAssets.Num(), [this](int32 index) {
+		if (bCancelled) return;
+		FMD5Hash hash = FMD5Hash::HashFile(*mFilenames[index]);
+		if (hash.IsValid())
+		{
+			mHashes[index] = LexToString(hash);
+		}
+	});
+
+	// Skip assets whose package is unchanged since the last export and whose image is still there
+	IFileManager& fileMgr = IFileManager::Get();
+	for (int32 i = 0; i < mAssets.Num(); ++i)
+	{
+		const ManifestEntry* entry = mManifest.Find(mAssets[i].ObjectPath);
+		if (entry && !mHashes[i].IsEmpty() && entry->Hash == mHashes[i]
+			&& entry->ResolutionX == mSettings.ResolutionX && entry->ResolutionY == mSettings.ResolutionY
+			&& fileMgr.FileSize(*(mSettings.OutputDir / entry->File)) > 0)
+		{
+			++mNumSkipped;
+			continue;
+		}
+		mRenderQueue.Add(i);
+	}
+}
+
+bool ThumbnailBatchExporter::tick(float DeltaTime)
+{
+	drainResults();
+	if (!bHashed) return true;
+
+	const double deadline = FPlatformTime::Seconds() + mSettings.FrameBudgetSeconds;
+	while (!bCancelled && mRenderCursor < mRenderQueue.Num() && mPendingWrites.GetValue() < mSettings.MaxPendingWrites)
+	{
+		renderOne(mRenderQueue[mRenderCursor++]);
+		if (FPlatformTime::Seconds() >= deadline) break;
+	}
+
+	const bool bRenderDone = bCancelled || mRenderCursor >= mRenderQueue.Num();
+	if (bRenderDone && mPendingWrites.GetValue() == 0)
+	{
+		drainResults();
+		finish();
+		return false;
+	}
+	return true;
+}
+
+void ThumbnailBatchExporter::renderOne(int32 index)
+{
+	const FAssetData& asset = mAssets[index];
+	UObject* object = asset.GetAsset();
+	if (!object)
+	{
+		++mNumFailed;
+		return;
+	}
+
+	FObjectThumbnail thumbnail;
+	ThumbnailTools::RenderThumbnail(object, mSettings.ResolutionX, mSettings.ResolutionY, ThumbnailTools::EThumbnailTextureFlushMode::AlwaysFlush, nullptr, &thumbnail);
+	const int32 width = thumbnail.GetImageWidth();
+	const int32 height = thumbnail.GetImageHeight();
+	TArray<uint8> pixels = MoveTemp(thumbnail.AccessImageData());
+
+	if (++mLoadedSinceGC >= mSettings.GCInterval)
+	{
+		mLoadedSinceGC = 0;
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	if (pixels.Num() == 0 || width <= 0 || height <= 0)
+	{
+		++mNumFailed;
+		return;
+	}
+
+	WriteResult result;
+	result.ObjectPath = asset.ObjectPath;
+	result.Entry.Hash = mHashes[index];
+	result.Entry.File = outputFileFor(asset);
+	result.Entry.ResolutionX = mSettings.ResolutionX;
+	result.Entry.ResolutionY = mSettings.ResolutionY;
+
+	// Encode and write on the pool, the game thread only renders
+	IImageWrapperModule* imageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	const FString fullPath = mSettings.OutputDir / result.Entry.File;
+	const int32 quality = mSettings.Quality;
+	mPendingWrites.Increment();
+	Async(EAsyncExecution::ThreadPool, [this, imageWrapperModule, pixels = MoveTemp(pixels), width, height, quality, fullPath, result = MoveTemp(result)]() mutable {
+		TSharedPtr<IImageWrapper> wrapper = imageWrapperModule->CreateImageWrapper(EImageFormat::JPEG);
+		if (wrapper.IsValid() && wrapper->SetRaw(pixels.GetData(), pixels.Num(), width, height, ERGBFormat::BGRA, 8))
+		{
+			const auto& compressed = wrapper->GetCompressed(quality);
+			result.bSuccess = compressed.Num() > 0 && FFileHelper::SaveArrayToFile(compressed, *fullPath);
+		}
+		mResults.Enqueue(MoveTemp(result));
+		mPendingWrites.Decrement();
+	});
+}
+
+void ThumbnailBatchExporter::drainResults()
+{
+	WriteResult result;
+	while (mResults.Dequeue(result))
+	{
+		if (result.bSuccess)
+		{
+			mManifest.Add(result.ObjectPath, result.Entry);
+			++mNumExported;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Thumbnail export failed: %s"), *result.ObjectPath.ToString());
+			++mNumFailed;
+		}
+	}
+}
+
+void ThumbnailBatchExporter::finish()
+{
+	saveManifest();
+	bFinished = true;
+	UE_LOG(LogTemp, Log, TEXT("Thumbnail export%s: %d exported, %d unchanged, %d failed in %.2fs -> %s"),
+		bCancelled ? TEXT(" cancelled") : TEXT(""), mNumExported, GetNumSkipped(), mNumFailed,
+		FPlatformTime::Seconds() - mStartTime, *mSettings.OutputDir);
+	OnFinished.ExecuteIfBound(*this);
+}
+
+FString ThumbnailBatchExporter::outputFileFor(const FAssetData& asset) const
+{
+	// "/Game/Lib/Mesh" -> "Game/Lib/Mesh.jpg"
+	FString file = asset.PackageName.ToString();
+	file.RemoveFromStart(TEXT("/"));
+	return file + TEXT(".jpg");
+}
+
+void ThumbnailBatchExporter::loadManifest()
+{
+	FString json;
+	if (!FFileHelper::LoadFileToString(json, *(mSettings.OutputDir / ManifestName)))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> root;
+	TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+	if (!FJsonSerializer::Deserialize(reader, root) || !root.IsValid())
+	{
+		return;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* assets = nullptr;
+	if (root->TryGetArrayField(TEXT("Assets"), assets))
+	{
+		for (const TSharedPtr<FJsonValue>& value : *assets)
+		{
+			const TSharedPtr<FJsonObject>* object = nullptr;
+			FString objectPath;
+			if (!value->TryGetObject(object) || !(*object)->TryGetStringField(TEXT("Object"), objectPath))
+			{
+				continue;
+			}
+
+			ManifestEntry entry;
+			(*object)->TryGetStringField(TEXT("Hash"), entry.Hash);
+			(*object)->TryGetStringField(TEXT("File"), entry.File);
+			(*object)->TryGetNumberField(TEXT("ResolutionX"), entry.ResolutionX);
+			(*object)->TryGetNumberField(TEXT("ResolutionY"), entry.ResolutionY);
+			mManifest.Add(FName(*objectPath), entry);
+		}
+	}
+}
+
+void ThumbnailBatchExporter::saveManifest() const
+{
+	TArray<TSharedPtr<FJsonValue>> assets;
+	assets.Reserve(mManifest.Num());
+	for (const TPair<FName, ManifestEntry>& pair : mManifest)
+	{
+		TSharedPtr<FJsonObject> object = MakeShared<FJsonObject>();
+		object->SetStringField(TEXT("Object"), pair.Key.ToString());
+		object->SetStringField(TEXT("Hash"), pair.Value.Hash);
+		object->SetStringField(TEXT("File"), pair.Value.File);
+		object->SetNumberField(TEXT("ResolutionX"), pair.Value.ResolutionX);
+		object->SetNumberField(TEXT("ResolutionY"), pair.Value.ResolutionY);
+		assets.Add(MakeShared<FJsonValueObject>(object));
+	}
+
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	root->SetNumberField(TEXT("Version"), 1);
+	root->SetStringField(TEXT("Generated"), FDateTime::UtcNow().ToIso8601());
+	root->SetArrayField(TEXT("Assets"), assets);
+
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+	FFileHelper::SaveStringToFile(json, *(mSettings.OutputDir / ManifestName), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+// Mount.ExportThumbnails <MountRoot> <OutputDir> [Resolution]
+static FAutoConsoleCommand GExportThumbnailsCommand(
+	TEXT("Mount.ExportThumbnails"),
+	TEXT("Export jpg thumbnails for every asset under a mount root. Args: <MountRoot> <OutputDir> [Resolution]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() < 2)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: Mount.ExportThumbnails <MountRoot> <OutputDir> [Resolution]"));
+			return;
+		}
+		ThumbnailExportSettings settings;
+		settings.OutputDir = Args[1];
+		if (Args.Num() > 2)
+		{
+			settings.ResolutionX = settings.ResolutionY = FMath::Max(16, FCString::Atoi(*Args[2]));
+		}
+		ThumbnailBatchExporter::ExportMountRoot(Args[0], settings);
+	})
+);
@@ -2,6 +2,22 @@
 #include "Misc/FileHelper.h"
 #include "Interfaces/IPluginManager.h"
 #include "MountManager.h"
+#include "AssetCopyEngine.h"
+#include "AssetMoveBatch.h"
+#include "MeshCombiner.h"
+#include "AssetQuery.h"
+#include "AssetNameIndex.h"
+#include "AssetDataResolver.h"
+#include "PluginUpdater.h"
+#include "MountConfigSnapshot.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
+#include "AbcImportQueue.h"
+#include "AbcImportSettings.h"
+#include "AssetImportTask.h"
+#include "AssetToolsModule.h"
+#include "ContentBrowserModule.h"
+#include "IContentBrowserSingleton.h"
 
 Utilities::Utilities()
 {
@@ -10,11 +26,7 @@ Utilities::Utilities()
 
 Utilities& Utilities::Get()
 {
-	static TUniquePtr<Utilities> Singleton;
-	if (!Singleton)
-	{
-		Singleton = MakeUnique<Utilities>();
-	}
+	static TUniquePtr<Utilities> Singleton = MakeUnique<Utilities>();
 	return *Singleton;
 }
 
@@ -36,11 +48,83 @@ void Utilities::PreInit()
 	
 	auto plugin = IPluginManager::Get().FindPlugin(TEXT("Mount"));
 	mPluginVersionName = plugin->GetDescriptor().VersionName;
+
+	// Files replaced by the update applied at the last shutdown
+	PluginUpdater::Get().CleanupOldFiles(mPluginPath);
 }
 
 void Utilities::Init()
 {
 	MountManager::Get().Init(mPluginPath);
+	// Built here so it binds to registry events on the game thread
+	AssetNameIndex::Get();
+	checkUpdate();
+}
+
+void Utilities::Shutdown()
+{
+	if (mTickDelegateHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(mTickDelegateHandle);
+		mTickDelegateHandle.Reset();
+	}
+	PluginUpdater::Get().Cancel();
+	updatePluginByDrive();
+}
+
+void Utilities::checkUpdate()
+{
+	MountConfigSnapshot snapshot;
+	snapshot.Load(mPluginConfigPath);
+	if (!snapshot.bUpdateEnabled || snapshot.UpdateSource.IsEmpty()) return;
+
+	// The ticker only runs once the editor loop does, the check never holds up startup
+	mUpdateSource = snapshot.UpdateSource;
+	mTickDelegate = FTickerDelegate::CreateLambda([this](float DeltaTime) {
+		mTickDelegateHandle.Reset();
+		updateByDrive();
+		return false;
+	});
+	mTickDelegateHandle = FTicker::GetCoreTicker().AddTicker(mTickDelegate, FMath::Max(snapshot.UpdateCheckDelaySeconds, 0.f));
+}
+
+#define LOCTEXT_NAMESPACE "FMountModule"
+void Utilities::updateByDrive()
+{
+	PluginUpdater::Get().CheckAsync(mUpdateSource, mPluginPath, [this](const PluginUpdateResult& result) {
+		if (!result.bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Mount plugin update check against %s failed: %s"), *mUpdateSource, *result.Error);
+			return;
+		}
+		UE_LOG(LogTemp, Log, TEXT("Mount plugin update %s: %d of %d files differ, %d removed, %.1f KB copied in %.1fs"), *result.Version,
+			result.NumChanged, result.NumFiles, result.NumRemoved, result.CopiedBytes / 1024.0, result.Seconds);
+		if (result.NumChanged == 0 && result.NumRemoved == 0) return;
+
+		FNotificationInfo info(FText::Format(LOCTEXT("PluginUpdateStaged", "Mount {0} is ready, {1} files are updated when the editor restarts"),
+			FText::FromString(result.Version), FText::AsNumber(result.NumChanged + result.NumRemoved)));
+		info.bFireAndForget = false;
+		info.ButtonDetails.Add(FNotificationButtonInfo(LOCTEXT("PluginUpdateDismiss", "Dismiss"), FText::GetEmpty(),
+			FSimpleDelegate::CreateRaw(this, &Utilities::onCloseNotify), SNotificationItem::CS_None));
+		mNotifyItem = FSlateNotificationManager::Get().AddNotification(info);
+	});
+}
+
+#undef LOCTEXT_NAMESPACE
+
+void Utilities::updatePluginByDrive()
+{
+	PluginUpdater::Get().ApplyStaged(mPluginPath);
+}
+
+void Utilities::onCloseNotify()
+{
+	TSharedPtr<SNotificationItem> item = mNotifyItem.Pin();
+	if (item.IsValid())
+	{
+		item->ExpireAndFadeout();
+	}
+	mNotifyItem.Reset();
 }
 
 void Utilities::AddUICommand(TSharedPtr< FUICommandInfo > uiCommand, FExecuteAction ExecuteAction)
@@ -141,3 +225,99 @@ void Utilities::makeIniFile(const FString& iniFile)
 		FFileHelper::SaveStringToFile(TEXT(" "), *iniFile, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
 	}
 }
+
+void Utilities::AdvancedCopyAssets(const TArray<FAssetData>& Assets, const FString& DestPath)
+{
+	AssetCopyEngine::CopyAssets(Assets, DestPath);
+}
+
+void Utilities::MoveAssets(const TArray<UObject*>& Assets, const FString& DestPath, const TMap<UObject*, FString>& NewNameMap, const FString& SourcePath)
+{
+	AssetMoveBatch::MoveAssets(Assets, DestPath, NewNameMap, SourcePath);
+}
+
+void Utilities::CopyMetaData(const TMap<FName, FString>& SourceAndDestPackages)
+{
+	AssetMoveBatch::CopyMetaData(SourceAndDestPackages);
+}
+
+bool Utilities::CombineActor(const TArray<AActor*>& Actors, AStaticMeshActor*& OutActor, FString MeshName, FString Path, bool SpawnMesh, bool DestroyReplacedActors)
+{
+	return MeshCombiner::CombineActors(Actors, OutActor, MeshName, Path, SpawnMesh, DestroyReplacedActors);
+}
+
+void Utilities::GetAssetsUnderPath(const TArray<FName>& paths, bool isRecursive, TArray<FAssetData>& OutAssetDatas)
+{
+	AssetQueryOptions options;
+	options.bRecursive = isRecursive;
+	AssetQuery::ForEachPage(paths, options, [&OutAssetDatas](TArrayView<const FAssetData> page) {
+		OutAssetDatas.Append(page.GetData(), page.Num());
+		return true;
+	});
+}
+
+bool Utilities::GetAssetDataAt(const FString& dataPath, FAssetData& OutAssetData)
+{
+	return AssetDataResolver::Get().Resolve(dataPath, OutAssetData);
+}
+
+void Utilities::GetAssetDataAt(const TArray<FString>& dataPaths, TArray<FAssetData>& OutAssetDatas)
+{
+	AssetDataResolver::Get().Resolve(dataPaths, OutAssetDatas);
+}
+
+FString Utilities::GetSHA2(FString inPath)
+{
+	TArray<uint8> data;
+	FSHA256Signature signature;
+	if (!FFileHelper::LoadFileToArray(data, *inPath) || !FPlatformMisc::GetSHA256Signature(data.GetData(), data.Num(), signature))
+	{
+		return FString();
+	}
+	return signature.ToString();
+}
+
+void Utilities::CreateUniqueAssetName(const FString& InBasePackageName, const FString& InSuffix, FString& OutPackageName, FString& OutAssetName)
+{
+	AssetNameIndex::Get().CreateUniqueAssetName(InBasePackageName, InSuffix, OutPackageName, OutAssetName);
+}
+
+void Utilities::ImportAbc(const TArray<FString>& FileNames)
+{
+	// One batch at a time, a second one would share the memory budget
+	static TSharedPtr<AbcImportQueue> Queue;
+	if (Queue.IsValid() && !Queue->IsFinished())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Abc import still running, %d files not queued"), FileNames.Num());
+		return;
+	}
+
+	// Content browser paths may be virtual, "/All/Game/Folder"
+	FContentBrowserModule& contentBrowser = FModuleManager::LoadModuleChecked<FContentBrowserModule>(TEXT("ContentBrowser"));
+	FString destPath = contentBrowser.Get().GetCurrentPath();
+	destPath.RemoveFromStart(TEXT("/All"));
+	if (!destPath.StartsWith(TEXT("/"))) destPath = TEXT("/Game");
+
+	AbcImportSettings settings;
+	settings.DestPath = destPath;
+	Queue = AbcImportQueue::Start(FileNames, settings);
+}
+
+void Utilities::ImportSingleAbc(const FString& InFileName, const FString& OutFilePath)
+{
+	UAbcImportSettings* abcSettings = NewObject<UAbcImportSettings>();
+	abcSettings->ImportType = EAlembicImportType::StaticMesh;
+	abcSettings->StaticMeshSettings.bMergeMeshes = true;
+
+	UAssetImportTask* task = NewObject<UAssetImportTask>();
+	task->Filename = InFileName;
+	task->DestinationPath = OutFilePath;
+	task->bAutomated = true;
+	task->bReplaceExisting = true;
+	// AbcImportQueue saves and unloads in batches
+	task->bSave = false;
+	task->Options = abcSettings;
+
+	IAssetTools& assetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools")).Get();
+	assetTools.ImportAssetTasks({ task });
+}
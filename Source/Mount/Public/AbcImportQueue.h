@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class SNotificationItem;
+
+struct AbcImportSettings
+{
+	// Content path handed to Utilities::ImportSingleAbc
+	FString DestPath;
+	// Imported packages are saved and unloaded once the process has grown by this much since the
+	// last flush, so the editor's own footprint does not count against it
+	uint64 MemoryBudgetBytes = 4ull * 1024 * 1024 * 1024;
+	// Bytes of upcoming .abc files warmed in the OS cache while the current one imports
+	uint64 ReadAheadBytes = 1024ull * 1024 * 1024;
+	// Save and unload after this many files even if under budget
+	int32 FlushInterval = 8;
+};
+
+// Streams a list of .abc files through Utilities::ImportSingleAbc one file per frame.
+// Upcoming files are read ahead on the pool, imported packages are saved and unloaded
+// incrementally so memory stays flat regardless of the batch size.
+class AbcImportQueue : public TSharedFromThis<AbcImportQueue>
+{
+public:
+	static TSharedPtr<AbcImportQueue> Start(const TArray<FString>& fileNames, const AbcImportSettings& settings);
+
+	AbcImportQueue(const TArray<FString>& fileNames, const AbcImportSettings& settings);
+	~AbcImportQueue();
+
+	void Cancel() { bCancelled = true; }
+	bool IsFinished() const { return bFinished; }
+	int32 GetNumImported() const { return mNumImported; }
+	// Most the process grew by between two flushes
+	uint64 GetPeakHeldBytes() const { return mPeakHeldBytes; }
+
+private:
+	void start();
+	bool tick(float DeltaTime);
+	void importNext();
+	void scheduleReadAhead();
+	void flushImported();
+	void finish();
+	void onAssetPostImport(class UFactory* InFactory, UObject* InCreatedObject);
+	void updateNotification();
+
+	AbcImportSettings mSettings;
+	TArray<FString> mFiles;
+	TArray<int64> mFileSizes;
+	int32 mCursor = 0;
+	// First file not yet handed to the read-ahead worker
+	int32 mReadAheadCursor = 0;
+	TBitArray<> mWarmed;
+	uint64 mReadAheadInFlight = 0;
+	TArray<TFuture<void>> mReadAheadTasks;
+
+	TArray<TWeakObjectPtr<UPackage>> mPendingPackages;
+	int32 mSinceFlush = 0;
+	// Used physical memory right after the last flush, what is above it is held by the queue
+	uint64 mBaseUsedBytes = 0;
+
+	TWeakPtr<SNotificationItem> mNotification;
+	FDelegateHandle mPostImportHandle;
+	TAtomic<bool> bCancelled{ false };
+	bool bFinished = false;
+
+	int32 mNumImported = 0;
+	uint64 mPeakHeldBytes = 0;
+	double mStartTime = 0.0;
+};
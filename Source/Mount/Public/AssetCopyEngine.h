@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetData.h"
+
+struct AssetCopyStats
+{
+	int32 NumRequested = 0;
+	// Packages in the dependency closure after deduplication
+	int32 NumPackages = 0;
+	int32 NumCopied = 0;
+	// Destination already held an identical package
+	int32 NumUpToDate = 0;
+	int32 NumFixedUp = 0;
+	double ClosureSeconds = 0.0;
+	double CopySeconds = 0.0;
+	double FixupSeconds = 0.0;
+};
+
+// Copies assets with their dependencies from mounted libraries into the project.
+// The dependency closure is computed once so shared packages are copied once, package files
+// are copied in parallel (block-cloned where the volume supports it) and references from the
+// copies to their sources are redirected in a single pass at the end.
+class AssetCopyEngine
+{
+public:
+	static bool CopyAssets(const TArray<FAssetData>& assets, const FString& destPath, AssetCopyStats* outStats = nullptr);
+
+private:
+	struct PackageCopy
+	{
+		FName SourcePackage;
+		FName DestPackage;
+		FString SourceFile;
+		FString DestFile;
+		// Other packages of the closure this one imports
+		TArray<int32> Dependencies;
+		bool bUpToDate = false;
+		bool bCopied = false;
+	};
+
+	static void gatherClosure(const TArray<FAssetData>& assets, TArray<PackageCopy>& outCopies);
+	static void mapDestinations(const FString& destPath, TArray<PackageCopy>& copies);
+	static void copyFiles(TArray<PackageCopy>& copies);
+	static int32 fixupReferences(const TArray<PackageCopy>& copies);
+	static bool cloneFile(const FString& source, const FString& dest);
+};
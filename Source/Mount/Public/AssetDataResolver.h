@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetData.h"
+
+// Resolves asset paths to FAssetData in batches: inputs are grouped by mount point and each group is
+// one registry query. Results, including misses, are memoized until the registry reports a change
+// for that asset. Game thread only, like the registry queries it makes.
+class AssetDataResolver
+{
+public:
+	static AssetDataResolver& Get();
+
+	// Accepts object paths ("/Game/Lib/Rock.Rock"), package names ("/Game/Lib/Rock") and package filenames.
+	// outAssets gets one entry per input, invalid where nothing was found.
+	void Resolve(const TArray<FString>& paths, TArray<FAssetData>& outAssets);
+	bool Resolve(const FString& path, FAssetData& outAsset);
+
+	void Shutdown();
+	int32 GetNumQueries() const { return mNumQueries; }
+
+private:
+	struct Key
+	{
+		FName Name;
+		bool bIsPackage = false;
+		// Top two segments, "/Game/Lib"
+		FName MountPoint;
+	};
+
+	bool makeKey(const FString& path, Key& outKey) const;
+	void bindRegistry();
+	void invalidate(FName objectPath, FName packageName);
+	void onAssetChanged(const FAssetData& asset);
+	void onAssetRenamed(const FAssetData& asset, const FString& oldObjectPath);
+
+	// Object path or package name -> result, invalid for a miss
+	TMap<FName, FAssetData> mObjects;
+	TMap<FName, FAssetData> mPackages;
+	bool bBoundRegistry = false;
+	int32 mNumQueries = 0;
+};
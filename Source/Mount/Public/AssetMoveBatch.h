@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct AssetMoveStats
+{
+	int32 NumAssets = 0;
+	// Less than NumAssets when RenameAssets failed part way
+	int32 NumMoved = 0;
+	int32 NumRedirectorsFixed = 0;
+	// Every package save during the move, RenameAssets and FixupReferencers save referencers themselves
+	int32 NumPackagesSaved = 0;
+	double ValidateSeconds = 0.0;
+	double RenameSeconds = 0.0;
+	double FixupSeconds = 0.0;
+	double SaveSeconds = 0.0;
+};
+
+// Moves a selection as one batch: every destination is validated before anything is renamed,
+// all renames go through a single RenameAssets call and the redirectors left behind are fixed up in
+// one pass. What those two leave dirty is saved at the end. If the renames fail part way, nothing
+// is fixed up or saved and the assets that did move are reported.
+class AssetMoveBatch
+{
+public:
+	// Nothing is moved if any destination collides. False if anything was not moved.
+	static bool MoveAssets(const TArray<UObject*>& assets, const FString& destPath, const TMap<UObject*, FString>& newNameMap, const FString& sourcePath = FString(), AssetMoveStats* outStats = nullptr);
+	// Copy package metadata from each source package onto its destination package
+	static void CopyMetaData(const TMap<FName, FString>& sourceAndDestPackages);
+};
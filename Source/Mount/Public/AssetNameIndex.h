@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetData.h"
+
+// Per-directory index of taken asset names used to hand out unique names during bulk imports and copies.
+// A directory is indexed once, from the asset registry on the game thread or from a disk listing on
+// other threads, then kept current by registry events and by the names it reserves itself.
+// Allocation is O(1) amortized and safe to call from concurrent importers.
+class AssetNameIndex
+{
+public:
+	static AssetNameIndex& Get();
+	AssetNameIndex();
+
+	// Same contract as IAssetTools::CreateUniqueAssetName, the returned name is reserved
+	void CreateUniqueAssetName(const FString& basePackageName, const FString& suffix, FString& outPackageName, FString& outAssetName);
+	void Shutdown();
+
+private:
+	struct DirectoryIndex
+	{
+		// Lower case asset names
+		TSet<FString> Taken;
+		// Lower case base name -> next numeric suffix to try
+		TMap<FString, int32> NextSuffix;
+	};
+
+	DirectoryIndex& findOrBuild(const FString& packagePath);
+	void buildFromRegistry(const FString& packagePath, DirectoryIndex& index);
+	void buildFromDisk(const FString& packagePath, DirectoryIndex& index);
+	void onAssetAdded(const FAssetData& asset);
+	void onAssetRemoved(const FAssetData& asset);
+	void onAssetRenamed(const FAssetData& asset, const FString& oldObjectPath);
+
+	FCriticalSection mLock;
+	// Lower case package path -> index
+	TMap<FString, TUniquePtr<DirectoryIndex>> mDirectories;
+	bool bBoundRegistry = false;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetData.h"
+
+struct AssetQueryOptions
+{
+	bool bRecursive = true;
+	// Skip loaded objects that are not saved yet, avoids building asset data for every loaded object
+	bool bOnlyOnDisk = false;
+	int32 PageSize = 1024;
+	TArray<FName> ClassNames;
+	// Runs during the walk, assets it rejects never reach a page
+	TFunction<bool(const FAssetData&)> Filter;
+};
+
+// Streams registry results in fixed size pages instead of one array holding a whole library.
+// Page callbacks return false to stop the walk early.
+class AssetQuery
+{
+public:
+	typedef TFunctionRef<bool(TArrayView<const FAssetData>)> FOnPage;
+	typedef TFunction<bool(int32 /*RootIndex*/, TArrayView<const FAssetData>)> FOnParallelPage;
+
+	// Returns the number of assets delivered
+	static int32 ForEachPage(const TArray<FName>& paths, const AssetQueryOptions& options, FOnPage onPage);
+	static int32 ForEachAsset(const TArray<FName>& paths, const AssetQueryOptions& options, TFunctionRef<bool(const FAssetData&)> onAsset);
+
+	// One walk per mount root. The registry is only readable from the game thread in this engine,
+	// so roots are walked there while filtering and page callbacks run concurrently on the task graph.
+	// Filter and onPage must be thread safe here.
+	static int32 ForEachPageParallel(const TArray<FName>& roots, const AssetQueryOptions& options, const FOnParallelPage& onPage);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FileHelper.h"
+
+// Writes a file next to its destination and renames it over the old one in a single call
+// (MoveFileExW with MOVEFILE_REPLACE_EXISTING, rename(2) elsewhere). The destination is never
+// missing in between, readers opening it see either the old content or the new one.
+class AtomicFile
+{
+public:
+	// Replaces target by source, source is gone on success
+	static bool Replace(const FString& target, const FString& source);
+
+	static bool SaveArrayToFile(TArrayView<const uint8> bytes, const FString& file);
+	static bool SaveStringToFile(const FString& text, const FString& file, FFileHelper::EEncodingOptions encoding = FFileHelper::EEncodingOptions::AutoDetect);
+
+private:
+	// Unique per writer, two processes saving the same file don't share a temp file
+	static FString makeTempPath(const FString& file);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Paths.h"
+
+struct DirectoryEntry
+{
+	// Absolute path
+	FString Path;
+	bool bIsDirectory = false;
+	int64 Size = -1;
+	FDateTime ModificationTime;
+
+	FString GetName() const { return FPaths::GetCleanFilename(Path); }
+};
+
+// Directory listing with type, size and mtime coming from the enumeration itself,
+// so callers never stat the entries again. On a network share every filesystem call is a round-trip,
+// the walker counts them so mount code can report what a mount cost.
+class DirectoryWalker
+{
+public:
+	// Immediate children, one filesystem call
+	bool List(const FString& dir, TArray<DirectoryEntry>& outEntries);
+	// One filesystem call per directory
+	bool ListRecursive(const FString& dir, TArray<DirectoryEntry>& outEntries);
+	// One filesystem call, replaces DirectoryExists + FileSize + GetTimeStamp
+	bool Stat(const FString& path, DirectoryEntry& outEntry);
+	bool DirectoryExists(const FString& path);
+
+	int32 GetNumCalls() const { return mNumCalls; }
+	// All walkers since startup
+	static uint64 GetTotalCalls();
+
+private:
+	void countCall();
+
+	int32 mNumCalls = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct LibraryUploadSettings
+{
+	// Root of the shared library store, holds chunks/ and libraries/
+	FString StoreDir;
+	FString LibraryName;
+	// Content defined chunking bounds, the average chunk is 2^AverageChunkBits bytes
+	int32 MinChunkBytes = 16 * 1024;
+	int32 AverageChunkBits = 16;
+	int32 MaxChunkBytes = 256 * 1024;
+};
+
+struct LibraryUploadStats
+{
+	int32 NumFiles = 0;
+	// Same size and mtime as in the previous manifest, not read at all
+	int32 NumUnchangedFiles = 0;
+	int32 NumChunks = 0;
+	int32 NumNewChunks = 0;
+	int64 TotalBytes = 0;
+	int64 NewBytes = 0;
+	double Seconds = 0.0;
+};
+
+// Publishes a folder into a content addressed store. Files are cut into content defined chunks named by
+// their SHA-1, only chunks the store doesn't have are written, and the library manifest listing each
+// file's chunks is replaced in one rename. Republishing after a small edit writes only the chunks
+// around the edit, and readers never see a manifest pointing at chunks that are not there yet.
+class LibraryUploader
+{
+public:
+	static bool Upload(const FString& sourceDir, const LibraryUploadSettings& settings, LibraryUploadStats* outStats = nullptr);
+
+	static FString GetManifestPath(const LibraryUploadSettings& settings);
+	static FString GetChunkPath(const FString& storeDir, const FString& chunkId);
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AStaticMeshActor;
+class UStaticMesh;
+
+struct MeshCombineStats
+{
+	int32 NumActors = 0;
+	int32 NumMeshes = 0;
+	int32 NumChunks = 0;
+	double GatherSeconds = 0.0;
+	double MergeSeconds = 0.0;
+	double BuildSeconds = 0.0;
+	// Highest process memory seen while merging, relative to the start
+	uint64 PeakExtraBytes = 0;
+	bool bCancelled = false;
+};
+
+// Merges the static meshes of many actors into one asset.
+// Only mesh description lookup and the final asset creation run on the game thread, transform
+// baking and vertex/index gathering run in parallel over chunks of actors.
+class MeshCombiner
+{
+public:
+	// Returns the new mesh in packagePath/meshName, pivoted at the first actor, or null if cancelled
+	static UStaticMesh* Combine(const TArray<AActor*>& actors, const FString& meshName, const FString& packagePath, MeshCombineStats* outStats = nullptr);
+
+	static bool CombineActors(const TArray<AActor*>& actors, AStaticMeshActor*& outActor, const FString& meshName, const FString& packagePath, bool spawnMesh, bool destroyReplacedActors);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+struct MountAuditRecord
+{
+	// UTC
+	FDateTime Time;
+	FString Computer;
+	FString User;
+	FString Ip;
+	FString Event;
+	FString Path;
+};
+
+struct MountAuditQuery
+{
+	// Case insensitive substring of the mounted path, empty matches everything
+	FString PathContains;
+	FString User;
+	// UTC
+	FDateTime From = FDateTime::MinValue();
+	FDateTime To = FDateTime::MaxValue();
+	int32 MaxResults = 1000;
+};
+
+// Append-only audit trail of mount events stored as segment files under <MountLogRootPath>/Audit.
+// Every editor session appends to its own segment, so writers never touch each other's files.
+// A sealed segment gets a small .idx sidecar (time range and distinct paths) which lets queries
+// skip segments without reading them. Sealed segments of this machine and user are merged in the
+// background once there are enough of them.
+class MountAuditStore
+{
+public:
+	static MountAuditStore& Get();
+	~MountAuditStore();
+
+	void Open(const FString& logRoot);
+	// Seals the active segment
+	void Close();
+	bool IsOpen() const { return !mAuditDir.IsEmpty(); }
+
+	// time is local, as written by MountManager::writeMountSign
+	void Append(const FString& path, const FString& event, const FDateTime& time);
+	// Newest first
+	TArray<MountAuditRecord> Query(const MountAuditQuery& query);
+
+	static const uint32 SegmentMagic;
+	static const uint32 IndexMagic;
+	static const uint16 Version;
+
+private:
+	struct SegmentInfo
+	{
+		FString File;
+		int64 Size = 0;
+		int64 MinTicks = MAX_int64;
+		int64 MaxTicks = MIN_int64;
+		int32 NumRecords = 0;
+		FString Computer;
+		FString User;
+		// Lower case
+		TSet<FString> Paths;
+		bool bSealed = false;
+	};
+
+	void openSegment();
+	void sealSegment();
+	void refreshSegments();
+	bool loadIndex(const FString& indexFile, SegmentInfo& info) const;
+	void saveIndex(const SegmentInfo& info) const;
+	bool readSegment(const FString& file, SegmentInfo& info, TArray<MountAuditRecord>* outRecords) const;
+	bool writeSegment(const FString& file, const FString& computer, const FString& user, const FString& ip, const TArray<MountAuditRecord>& records) const;
+	void compact();
+
+	FString mAuditDir;
+	FString mComputer;
+	FString mUser;
+	FString mIp;
+	// Segment file names of this machine and user start with this
+	FString mWriterPrefix;
+
+	TUniquePtr<class IFileHandle> mActiveHandle;
+	SegmentInfo mActive;
+	TArray<uint8> mRecordBuffer;
+
+	FCriticalSection mSegmentsLock;
+	TMap<FString, SegmentInfo> mSegments;
+	TFuture<void> mCompactTask;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct MountBenchmarkSettings
+{
+	// Tree, configs, results and baseline go here, Saved/MountBenchmark when empty
+	FString WorkDir;
+	// Levels of folders below each mounted folder
+	int32 Depth = 3;
+	int32 FanOut = 4;
+	int32 PackagesPerFolder = 8;
+	// Roots listed in MountedDirs, every fourth one is mounted through a [MountRule]
+	int32 NumRoots = 16;
+	// Roots added with registerMountPoint after startup
+	int32 NumNewRoots = 8;
+	int32 NumRules = 32;
+	// Added to every metadata call and open, a share is a round trip away
+	float LatencyMs = 1.f;
+	// Allowed growth of time and allocations against the baseline
+	float Tolerance = 0.1f;
+	bool bSaveBaseline = false;
+
+	// Phases are only compared against a baseline recorded with the same settings
+	FString ToString() const;
+};
+
+struct MountBenchmarkPhase
+{
+	FString Name;
+	double Seconds = 0.0;
+	// Made by the game thread
+	uint64 Allocations = 0;
+	uint64 AllocatedBytes = 0;
+	int64 FileCalls = 0;
+};
+
+// Counts heap allocations made by the constructing thread until destroyed. The first scope puts a
+// counting proxy in front of GMalloc, it stays there until MountAllocationScope::Uninstall.
+class MountAllocationScope
+{
+public:
+	MountAllocationScope();
+	~MountAllocationScope();
+
+	uint64 GetAllocations() const;
+	uint64 GetAllocatedBytes() const;
+
+	static void Uninstall();
+
+private:
+	uint64 mStartAllocations = 0;
+	uint64 mStartBytes = 0;
+	bool bWasCounting = false;
+};
+
+// Generates a synthetic library tree with its MountPluginConfig.ini and MountConfig.ini, replays
+// startup, background mounts, adding and unmounting and a burst of mount signs on a separate
+// MountManager behind injected filesystem latency, reads packages through a MountCachePlatformFile of
+// its own on the same slow directory, and writes timings and allocation counts to Result.json.
+// The replay registers its mount points with the engine under /MountBench/, so every mount and
+// unmount phase includes the engine's and the asset registry's share.
+// With a Baseline.json from the same settings, phases that got slower or allocate more than the
+// tolerance are reported.
+class MountBenchmark
+{
+public:
+	// False if generating failed or a phase regressed against the baseline
+	static bool Run(const MountBenchmarkSettings& settings);
+
+	static FString GetDefaultWorkDir();
+
+private:
+	static bool replay(const MountBenchmarkSettings& settings, const FString& workDir, const TArray<FString>& startupRoots, const TArray<FString>& newRoots, TArray<MountBenchmarkPhase>& outPhases);
+};
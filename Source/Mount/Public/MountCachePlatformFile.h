@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PassThroughPlatformFile.h"
+
+enum class MountCacheValidation : uint8
+{
+	Size,
+	SizeAndTime,
+	// Size and time, plus the local copy is hashed once per session against the hash taken when it was fetched
+	Hash,
+};
+
+struct MountCacheSettings
+{
+	FString CacheDir;
+	int64 MaxSizeBytes = 20ll * 1024 * 1024 * 1024;
+	MountCacheValidation Validation = MountCacheValidation::SizeAndTime;
+	// Files below these folders are cached
+	TArray<FString> Roots;
+	// Files whose path contains one of these are cached, same matching as [ReadonlyMountPath]
+	TArray<FString> ReadonlyWords;
+};
+
+// Read-through cache for packages on read-only network mounts. Mount points keep pointing at the share,
+// this layer sits in the platform file chain and serves reads of cached roots from a local copy.
+// The first open of a file reads from the share and starts a copy on the thread pool, the opener
+// never waits for it. Listings and stats still go to the share, so the editor sees the share's view.
+// The cache is kept under MaxSizeBytes by dropping the least recently opened files.
+class MountCachePlatformFile : public PassThroughPlatformFile
+{
+public:
+	static MountCachePlatformFile* Install(const MountCacheSettings& settings);
+	static void Uninstall();
+	// Null when the cache is disabled
+	static MountCachePlatformFile* Get();
+
+	virtual const TCHAR* GetName() const override { return TEXT("MountCache"); }
+	virtual IFileHandle* OpenRead(const TCHAR* Filename, bool bAllowWrite = false) override;
+	virtual IAsyncReadFileHandle* OpenAsyncRead(const TCHAR* Filename) override;
+	virtual IMappedFileHandle* OpenMapped(const TCHAR* Filename) override;
+	virtual IFileHandle* OpenWrite(const TCHAR* Filename, bool bAppend = false, bool bAllowRead = false) override;
+	virtual bool DeleteFile(const TCHAR* Filename) override;
+	virtual bool MoveFile(const TCHAR* To, const TCHAR* From) override;
+
+	void LogStats() const;
+
+private:
+	struct Entry
+	{
+		FString LocalFile;
+		int64 Size = 0;
+		int64 ModificationTicks = 0;
+		int64 LastAccessTicks = 0;
+		FString Hash;
+		bool bVerified = false;
+
+		friend FArchive& operator<<(FArchive& Ar, Entry& entry)
+		{
+			return Ar << entry.LocalFile << entry.Size << entry.ModificationTicks << entry.LastAccessTicks << entry.Hash;
+		}
+	};
+
+	explicit MountCachePlatformFile(const MountCacheSettings& settings);
+
+	bool isCachedPath(const FString& path) const;
+	FString localPathFor(const FString& path) const;
+	bool isCurrent(const Entry& entry, const FFileStatData& stat) const;
+	// Local copy of a cached path if it is current, otherwise a fetch is started and false returned
+	bool findLocalCopy(const TCHAR* Filename, FString& outLocalFile);
+	void scheduleFetch(const FString& path, const FString& key, const FFileStatData& stat);
+	bool fetch(const FString& path, const FFileStatData& stat, Entry& outEntry);
+	void waitForFetches();
+	// Stops copies in progress and waits for the fetch tasks to return
+	void stopFetches();
+	// Caller holds mLock
+	void evict();
+	void invalidate(const TCHAR* Filename);
+	void loadIndex();
+	void saveIndex();
+
+	MountCacheSettings mSettings;
+	FString mIndexFile;
+
+	mutable FCriticalSection mLock;
+	// Normalized lower case remote path
+	TMap<FString, Entry> mEntries;
+	int64 mTotalSize = 0;
+	// Keys being fetched, so concurrent opens of a file start one copy
+	TSet<FString> mFetching;
+	TAtomic<int32> mNumFetchTasks{ 0 };
+	TAtomic<bool> bStopping{ false };
+
+	TAtomic<int32> mNumHits{ 0 };
+	TAtomic<int32> mNumMisses{ 0 };
+	TAtomic<int32> mNumEvicted{ 0 };
+	TAtomic<int64> mBytesFetched{ 0 };
+
+	// Runs its own instance on a slow directory
+	friend class MountBenchmark;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One [MountRule] entry with its Requires list already split
+struct MountRule
+{
+	FString SubDir;
+	FString Entry;
+	TArray<FString> Requires;
+
+	friend FArchive& operator<<(FArchive& Ar, MountRule& Rule)
+	{
+		return Ar << Rule.SubDir << Rule.Entry << Rule.Requires;
+	}
+};
+
+// Parsed MountPluginConfig.ini cached as a .bin under the project's Saved/Mount.
+// The snapshot records the MD5 of the ini it was built from and is rebuilt whenever that changes,
+// so a normal startup is one read of each file and no GConfig parsing.
+struct MountConfigSnapshot
+{
+	static const uint32 Magic;
+	static const int32 Version;
+
+	FString IniHash;
+	TArray<MountRule> Rules;
+	TArray<FString> ReadonlyMountPaths;
+	// Candidates in config order, existence is checked later off the game thread
+	TArray<FString> MountLogRootPaths;
+	TArray<FString> MountNeedLogDirs;
+	TMap<FString, FString> OptionalDirs;
+	TMap<FString, FString> MustMountDirs;
+	// [MountAudit] LegacyTextLog, keep writing the old txt log, one file per user and folder, next to the audit store
+	bool bLegacyTextLog = false;
+	// [MountCache], local copies of packages on read-only roots
+	bool bCacheEnabled = false;
+	FString CacheDir;
+	int32 CacheMaxSizeMB = 20480;
+	// Size, SizeAndTime or Hash
+	FString CacheValidation;
+	TArray<FString> CacheRoots;
+	// [MountWarmup], read package headers of new mounts ahead of the registry
+	bool bWarmupEnabled = false;
+	int32 WarmupMaxConcurrency = 4;
+	int32 WarmupMaxMBPerSecond = 32;
+	int32 WarmupHeaderKB = 256;
+	// [PluginUpdate], folder holding a published plugin and its manifest.json
+	bool bUpdateEnabled = false;
+	FString UpdateSource;
+	// After the editor loop starts
+	float UpdateCheckDelaySeconds = 30.f;
+	// [MountCollision] Policy, Reject, Alias or Namespace for a folder whose /Game/ mount point is taken
+	FString CollisionPolicy;
+
+	// Fill from the snapshot if it matches the ini, otherwise parse the ini and rewrite the snapshot
+	void Load(const FString& iniPath);
+
+	static FString GetSnapshotPath(const FString& iniPath);
+
+private:
+	bool loadSnapshot(const FString& snapshotPath, const FString& iniHash);
+	void saveSnapshot(const FString& snapshotPath);
+	void parseIni(const FString& iniPath);
+	void serialize(FArchive& Ar);
+};
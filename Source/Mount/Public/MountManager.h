@@ -1,6 +1,13 @@
 ﻿#pragma once
 #include "CoreMinimal.h"
 #include "LevelEditor.h"
+#include "MountConfigSnapshot.h"
+#include "MountPathTable.h"
+#include "MountPointRegistry.h"
+#include "MountScheduler.h"
+#include "MountSignFormatter.h"
+#include "MountState.h"
+#include "MountTextLog.h"
 
 struct MountData
 {
@@ -56,6 +63,20 @@ struct MountData
 	}
 };
 
+// What mounting one root does, computed before anything is registered
+struct MountPlan
+{
+	FString Root;
+	// Mount point - folder
+	TArray<TPair<FString, FString>> Points;
+	// Recorded as SubDirs of the root's MountData
+	TArray<FString> SubDirs;
+	// Requires of a [MountRule], recorded as their own MountData
+	TArray<FString> RequiredDirs;
+	// Written as "Start Mount"
+	TArray<FString> SignDirs;
+};
+
 enum class MountMethod {
 	ByLevelConfig,
 	ByDirectory,
@@ -85,12 +106,36 @@ public:
 	void loadMountConfigs();
 	void mountIniFile(const FString& iniPath, MountMethod by);
 	void registerMountPoint(const FString& path, bool isNewAdd = false);
+	// Resolves the MountedDirs of the project config as if nothing was mounted and logs the clashes,
+	// registers nothing. Number of clashes.
+	int32 ValidateMountConfig();
+	// Logs what the mount bookkeeping costs now and what it would as FString maps
+	void ReportPathMemory() const;
+
+	// Safe on any thread, answered from the last published snapshot without waiting on mounts
+	bool IsPathMounted(const FString& path) const { return mMountState.IsPathMounted(path); }
+	bool GetMountPointForPath(const FString& path, FString& outPackagePath) const { return mMountState.GetMountPointForPath(path, outPackagePath); }
+	FMountStatePtr GetMountState() const { return mMountState.GetSnapshot(); }
+
+	// Named sets of mounted roots in the project config
+	TArray<FString> GetMountProfileNames() const;
+	void SaveMountProfile(const FString& name);
+	// Registers and unregisters only what differs from the current mounts, one config flush and one registry scan
+	bool SwitchMountProfile(const FString& name);
 
 	TArray<MountData> mMountedDatas;
+	// Bump whenever mMountedDatas changes so cached menu items get rebuilt
+	uint32 mMountedDatasRevision = 0;
 	const FString mAssetSection = TEXT("LevelMountPath");
 	MountMethod mByMethod;
 
 private:
+	struct PendingMountSign
+	{
+		FString Dir;
+		FString Content;
+		FDateTime Date;
+	};
 
 	// Mount config
 	void addMountedData(const MountData& data);
@@ -102,6 +147,12 @@ private:
 	void config2StrArr(TArray<FString>& dataStrs, const TArray<MountData>& inDatas = TArray<MountData>());
 	void StrArr2Config(const TArray<FString>& strArr, TArray<MountData>& outDatas);
 	void writeMountSign(const FString& dir, const FString& content);
+	void writeMountSign(const FString& dir, const FString& content, const FDateTime& date);
+	void resolveMountLogPath(const TArray<FString>& candidates);
+	// Signs still queued at shutdown are kept in Saved and written once a later session finds the log root
+	FString getPendingMountSignsPath() const;
+	void savePendingMountSigns();
+	void loadPendingMountSigns(TArray<PendingMountSign>& outSigns);
 	void writeAssetMountDirs();
 	void mountMustMountDirs();
 
@@ -111,6 +162,7 @@ private:
 	// Sub menu for mount recommended assets that user don't need to select in dialog 
 	void createOptionalDirSubMenu(FMenuBuilder& MenuBuilder);
 	void createUnmountLevelMenu(FMenuBuilder& MenuBuilder);
+	TSharedPtr<const TArray<TSharedPtr<MountData>>> getMountedItems();
 
 	// mount level
 	void levelRegisterMountPoint(const TArray<FString>& paths, bool isNewAdd = false);
@@ -121,24 +173,84 @@ private:
 	void onMountLevelClick();
 	TArray<FString> keepOuterFolder(TArray<FString>);
 
+	// With recordedSubDirs a Content root is planned from its MountData instead of a listing
+	void planMountPoint(const FString& path, MountPlan& outPlan, class DirectoryWalker& walker, const TArray<FString>* recordedSubDirs = nullptr) const;
+	// Moves or drops points that clash with what is mounted, by the collision policy, and takes the rest
+	void validateMountPlan(MountPlan& plan, TArray<MountCollision>& outCollisions);
+	void applyMountPlan(const MountPlan& plan, bool isNewAdd);
+	void addMountPointRequests(const MountPlan& plan, TArray<MountPointRequest>& outRequests);
+	// Whole config at once, folder - resolved point, nothing is listed or registered
+	void validateMountDatas(const TArray<MountData>& datas, bool bReplaceMounts, TMap<MountPathId, MountPathId>& outResolved, TArray<MountCollision>& outCollisions);
+	void reportCollisions(const TArray<MountCollision>& collisions, bool bNotify);
+	void createProfileSubMenu(FMenuBuilder& MenuBuilder);
+
+	// Config, scan and register, what Init does apart from the UI
+	void initMounts();
+	FString getProjectConfigPath() const;
+	FString getPluginConfigPath() const;
+	class MountAuditStore& auditStore();
+	void unregisterAllMountPoints();
+
 	// Mount point register manager
 	void AddMountPoint(FString, FString);
+	void RemoveMountPoint(MountPathId pointId, MountPathId pathId);
+	// What the engine is given for a point, the point itself unless isolated
+	FString getEngineMountPoint(const FString& point) const;
+	// Game thread, after a batch of Add/RemoveMountPoint
+	void publishMountState();
 
 	const FString mSectionName = TEXT("MountConfig");
 	const FString mMountPoint = TEXT("/Game/");
 	FString mMountLogPath;
+	// Log root is probed in the background, signs written before that are queued
+	bool bMountLogPathResolved = false;
+	uint32 mMountLogPathRequest = 0;
+	// Signs go to MountAuditStore, the old txt tree is only kept on request
+	bool bLegacyTextLog = false;
+	MountTextLog mTextLog;
+	TArray<PendingMountSign> mPendingMountSigns;
 	TArray<FString> mMountNeedLogDirs;
+	// mMountNeedLogDirs compiled, and the txt line format
+	MountSignFormatter mSignFormatter;
 	TArray<FString> mReadonlyMountPath;
-	TMap<FString, FString> mMountRules;
+	TArray<MountRule> mMountRules;
 	TMap<FString, FString> mOptionalDirs;
 	TMap<FString, FString> mMustMountDirs;
 	FString mMakeReadonlyEXEPath;
-	TArray<FString> mAssetMountDirs;
+	TArray<MountPathId> mAssetMountDirs;
 	TArray<FString> mMountLevelNames;
-	TMap<FString, FString> mMountPoints;
 
+	// Mount paths are interned, the maps below hold ids into mPathTable
+	MountPathTable mPathTable;
+	MountPathId mGameMountPointId;
 	// Mount Point - Long Mount Full Path
-	TMap<FString, FString> mPathToMountPoint;
-	TArray<FString> mMountPaths;
+	TMap<MountPathId, MountPathId> mMountPoints;
+	// Long Mount Full Path - Mount Point
+	TMap<MountPathId, MountPathId> mPathToMountPoint;
+	TSet<MountPathId> mMountPaths;
+	// Who holds each /Game/ point, consulted before anything is registered
+	MountPointRegistry mPointRegistry;
+	// What other threads see of the maps above
+	MountState mMountState;
+	uint32 mMountStateRevision = 0;
+
+	// Roots not needed by the startup map, mounted after the editor loop starts
+	TSharedPtr<MountScheduler> mMountScheduler;
+
+	// Set by MountBenchmark on its own instance: other config files and audit store, engine mount points
+	// under /MountBench/ instead of /Game/, and no cache layer, warm-up or startup map walk, so a replay
+	// still pays for engine registration but leaves the editor's /Game/ mounts alone
+	friend class MountBenchmark;
+	FString mProjectConfigOverride;
+	FString mPluginConfigOverride;
+	class MountAuditStore* mAuditStore = nullptr;
+	bool bIsolated = false;
+	const FString mIsolatedMountPoint = TEXT("/MountBench/");
+	// Roots an isolated manager mounts in Init, standing in for the startup map's
+	TSet<FString> mIsolatedStartupRoots;
+
+	// Unmount menu view model
+	TSharedPtr<const TArray<TSharedPtr<MountData>>> mMountedItems;
+	uint32 mMountedItemsRevision = 0;
 };
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Handle to an interned path, equal paths (ignoring case) get equal ids
+struct MountPathId
+{
+	int32 Index = INDEX_NONE;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	bool operator==(const MountPathId& other) const { return Index == other.Index; }
+	bool operator!=(const MountPathId& other) const { return Index != other.Index; }
+	friend uint32 GetTypeHash(const MountPathId& id) { return ::GetTypeHash(id.Index); }
+};
+
+// Interning table for the absolute and package paths mount bookkeeping keeps.
+// A path is a chain of segment nodes, so "D:/Lib/A/Content" and "D:/Lib/A/Content/Maps" share their
+// first four nodes and every segment string is stored once. Comparing two paths is comparing two ints.
+// Ids are never released, a session only ever sees a bounded set of mount paths.
+// Not thread safe, owned by the game thread.
+class MountPathTable
+{
+public:
+	MountPathId Intern(const FString& path);
+	// Invalid id if the path was never interned
+	MountPathId Find(const FString& path) const;
+	FString ToString(MountPathId id) const;
+
+	MountPathId GetParent(MountPathId id) const;
+	// "/Game/X/" -> "/Game/X", other ids are returned as they are
+	MountPathId TrimTrailingSeparator(MountPathId id) const;
+	// True for the path itself and anything below it, a trailing '/' on ancestor is ignored
+	bool IsUnder(MountPathId id, MountPathId ancestor) const;
+
+	int32 NumNodes() const { return mNodes.Num(); }
+	int32 NumSegments() const { return mSegments.Num(); }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct Node
+	{
+		int32 Parent;
+		int32 Segment;
+	};
+
+	static uint64 childKey(int32 parent, int32 segment)
+	{
+		return ((uint64)(uint32)(parent + 1) << 32) | (uint32)segment;
+	}
+
+	int32 findSegment(const FString& segment) const;
+
+	TArray<Node> mNodes;
+	TMap<uint64, int32> mChildren;
+	TArray<FString> mSegments;
+	// FString keys hash and compare case insensitively
+	TMap<FString, int32> mSegmentIds;
+};
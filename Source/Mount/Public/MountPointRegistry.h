@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MountPathTable.h"
+
+// What to do with a folder whose /Game/ mount point is taken
+enum class MountCollisionPolicy : uint8
+{
+	// Keep what holds the point, the folder is not mounted
+	Reject,
+	// Mount the folder at /Game/<Name>_2/, _3, ...
+	Alias,
+	// Mount the folder at /Game/<Library>/<Name>/, library being the folder its root sits in
+	Namespace,
+};
+
+struct MountPointRequest
+{
+	// Interned with or without the trailing '/'
+	MountPathId Point;
+	MountPathId Folder;
+	// Used by MountCollisionPolicy::Namespace, the request is rejected when empty
+	FString Namespace;
+};
+
+struct MountCollision
+{
+	FString MountPoint;
+	FString Folder;
+	// What holds the point: its folder, the folder's other point, or an owned point above or below it
+	FString Owner;
+	// Where the folder is mounted instead, empty if it was rejected
+	FString Resolved;
+};
+
+// Owner of every /Game/ mount point, keyed by interned point, so a clash is one map lookup when a
+// folder is registered instead of FPackageName silently shadowing the packages mounted there first.
+// Top folders of the project's Content own their points too, mounting over them hides project
+// packages. A point nested in an owned one, or holding owned ones below it, is a clash as well:
+// that is a walk up the few segments of the point and a count of owned points below each node.
+// A folder owns at most one point, mounting it a second time somewhere else is a clash.
+// Game thread, ids come from the owning MountManager's path table.
+class MountPointRegistry
+{
+public:
+	void Init(MountPathTable* table, MountPathId gameMountPoint);
+	void SetPolicy(MountCollisionPolicy policy) { mPolicy = policy; }
+	MountCollisionPolicy GetPolicy() const { return mPolicy; }
+	// Reject, Alias or Namespace, Reject for anything else
+	static MountCollisionPolicy ParsePolicy(const FString& name);
+
+	// One listing of the project's Content
+	void AddProjectFolders(const FString& contentDir, class DirectoryWalker& walker);
+
+	// Point the folder should be registered at, the requested one unless it clashes, invalid if the
+	// policy rejects it. A decision from Validate made earlier for the folder is taken over while its
+	// point is still free. Does not take the point, Register does.
+	MountPathId Resolve(const MountPointRequest& request, TArray<MountCollision>* outCollisions);
+	// Registering the same folder at the same point again does nothing
+	void Register(MountPathId point, MountPathId folder);
+	void Unregister(MountPathId point);
+	// Invalid if nothing holds the point
+	MountPathId FindOwner(MountPathId point) const;
+
+	// Resolves the requests in order as if each got registered, on a copy, nothing here changes.
+	// With bReplaceMounts only project folders are held at the start, for a config replacing all mounts.
+	void Validate(const TArray<MountPointRequest>& requests, bool bReplaceMounts, TMap<MountPathId, MountPathId>& outResolved, TArray<MountCollision>& outCollisions) const;
+	// Folder - point decided by Validate, so the order roots finish mounting in does not pick the winner
+	void SetReserved(TMap<MountPathId, MountPathId>&& reserved);
+
+	int32 NumOwned() const { return mOwners.Num(); }
+
+private:
+	struct Owner
+	{
+		MountPathId Folder;
+		bool bProject = false;
+	};
+
+	// Point without its trailing '/'
+	MountPathId key(MountPathId point) const { return mTable->TrimTrailingSeparator(point); }
+	bool isFree(MountPathId pointKey, MountPathId folder) const;
+	FString describeClash(MountPathId pointKey, MountPathId folder) const;
+	MountPathId findAlias(MountPathId pointKey, MountPathId folder);
+	void addOwner(MountPathId pointKey, const Owner& owner);
+	void removeOwner(MountPathId pointKey);
+	void removeMounts();
+
+	MountPathTable* mTable = nullptr;
+	MountPathId mGameKey;
+	MountCollisionPolicy mPolicy = MountCollisionPolicy::Reject;
+	TMap<MountPathId, Owner> mOwners;
+	// Folder - point key it owns
+	TMap<MountPathId, MountPathId> mFolderPoints;
+	// Owned points strictly below a node, a new point sees what is under it without a scan
+	TMap<MountPathId, int32> mOwnedBelow;
+	// Folder - point from Validate, invalid if rejected, and point key - folder of the valid ones
+	TMap<MountPathId, MountPathId> mReserved;
+	TMap<MountPathId, MountPathId> mReservedPoints;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class SNotificationItem;
+
+// Mounts roots in the background once the editor frame loop runs, a few per frame within a time budget.
+// The folders of queued roots are listed in the asset registry as empty paths so the content browser
+// shows them. Opening one moves its root to the front of the queue, loading a package from one
+// mounts its root right away.
+class MountScheduler : public TSharedFromThis<MountScheduler>
+{
+public:
+	struct Entry
+	{
+		FString Root;
+		// Top level /Game folders the root mounts, used to match content browser paths
+		TArray<FString> Folders;
+	};
+	typedef TFunction<void(const FString& /*Root*/)> FMountRoot;
+
+	static TSharedPtr<MountScheduler> Start(const TArray<Entry>& entries, FMountRoot mountRoot);
+
+	MountScheduler(const TArray<Entry>& entries, FMountRoot mountRoot);
+
+	// Queued roots stay unmounted, their placeholder folders are removed
+	void Cancel();
+	bool IsFinished() const { return bFinished; }
+	// Move the root covering this package path to the front of the queue
+	void Prioritize(const FString& packagePath);
+	// Mount the root covering this package path now if it is still queued
+	void MountNow(const FString& packagePath);
+	// Mount everything still queued now, on the calling (game) thread
+	void Flush();
+
+	// Frame time spent mounting per tick, at least one root is mounted every tick
+	static const double FrameBudgetSeconds;
+
+private:
+	void start();
+	void begin();
+	bool tick(float DeltaTime);
+	void finish();
+	void updateNotification(const FString& root);
+	// Index into mPending of the root providing the path's top /Game folder
+	int32 findPending(const FString& packagePath) const;
+	void addPlaceholders();
+	void removePlaceholders();
+
+	TArray<Entry> mPending;
+	FMountRoot mMountRoot;
+	int32 mNumTotal = 0;
+	int32 mNumMounted = 0;
+
+	TWeakPtr<SNotificationItem> mNotification;
+	FDelegateHandle mLoopInitHandle;
+	FDelegateHandle mPathChangedHandle;
+	FDelegateHandle mSyncLoadHandle;
+	// "/Game/<Folder>" paths added to the asset registry for queued roots
+	TArray<FString> mPlaceholders;
+	bool bCancelled = false;
+	bool bFinished = false;
+	double mStartTime = 0.0;
+};
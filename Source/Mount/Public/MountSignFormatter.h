@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+// Builds mount sign records without heap allocations once its buffers are warm. Need-log dirs are
+// compiled into per first character buckets at config load, host fields are formatted once, and
+// text output goes into a buffer owned by the calling thread that is reused by the next call.
+class MountSignFormatter
+{
+public:
+	// Case insensitive substrings, like the [MountNeedLogDir] entries
+	void SetNeedLogDirs(const TArray<FString>& needLogDirs);
+	// "  -  Computer  -  User  -  Ip  -  ", between date and event of a text line
+	void SetHost(const FString& computer, const FString& user, const FString& ip);
+
+	bool IsLogged(const FString& dir) const;
+
+	// "2024.01.31-12.00.00  -  Computer  -  User  -  Ip  -  Event", the legacy txt line.
+	// Valid until the next Format call on this thread.
+	FStringView FormatText(const FDateTime& date, const FString& event) const;
+	// Folder below the log root, "D:/Lib/Art" -> "D/Lib/Art", "//server/share" -> "server/share",
+	// empty for other paths. Valid until the next FormatLogSubPath call on this thread.
+	static FStringView FormatLogSubPath(const FString& dir);
+
+	// Binary record as stored in audit segments: uint32 size of the rest, int64 UTC ticks,
+	// then event and path as uint16 length and UTF-8 bytes, little endian
+	static void AppendRecord(TArray<uint8>& out, int64 ticks, const FString& event, const FString& path);
+	// uint16 length and UTF-8 bytes, longer strings are cut at 65535 bytes
+	static void AppendString(TArray<uint8>& out, const FString& str);
+
+private:
+	struct Pattern
+	{
+		// Offset and length in mPatternChars, lower case
+		int32 Start = 0;
+		int32 Len = 0;
+	};
+
+	bool matchesAt(const Pattern& pattern, const TCHAR* dir, int32 dirLen, int32 offset) const;
+
+	TArray<TCHAR> mPatternChars;
+	TArray<Pattern> mPatterns;
+	// Patterns by lower case first character, anything outside ASCII shares the last bucket
+	TArray<int32> mBuckets[129];
+	bool bMatchAll = false;
+	FString mHostText;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Immutable view of the registered mount points. A new one is published after every mount batch,
+// readers keep whatever snapshot they picked up for as long as they hold it.
+struct MountStateSnapshot
+{
+	uint32 Revision = 0;
+	// Mounted folder with trailing '/' - mount point with trailing '/', FString keys ignore case
+	TMap<FString, FString> FolderToMountPoint;
+	TSet<FString> MountPoints;
+	TArray<FString> MountedRoots;
+};
+
+typedef TSharedPtr<const MountStateSnapshot, ESPMode::ThreadSafe> FMountStatePtr;
+
+// Publishes mount state snapshots to readers on any thread. The lock only guards copying the pointer,
+// snapshots are built before it is taken, so readers never wait on a mount and mounts never wait on readers.
+class MountState
+{
+public:
+	MountState();
+
+	FMountStatePtr GetSnapshot() const;
+	void Publish(const FMountStatePtr& snapshot);
+
+	// Absolute folder or file, or package path
+	bool IsPathMounted(const FString& path) const;
+	// Package path of an absolute file or folder below a mounted folder, extension removed
+	bool GetMountPointForPath(const FString& path, FString& outPackagePath) const;
+
+	static bool IsPathMounted(const MountStateSnapshot& snapshot, const FString& path);
+	static bool GetMountPointForPath(const MountStateSnapshot& snapshot, const FString& path, FString& outPackagePath);
+
+private:
+	mutable FCriticalSection mLock;
+	FMountStatePtr mSnapshot;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+// The old txt mount log: one file per user and folder under the log root, holding every line the user
+// wrote for that folder and named after the latest one. A folder's file is looked up once, after that a
+// line is appended and the file renamed with plain OS calls, so a warm folder costs no heap allocations.
+// Files are UTF-8 without BOM, every line ends in a line break.
+class MountTextLog
+{
+public:
+	// Forgets the files found under the previous root, nothing is written while empty
+	void SetRoot(const FString& root);
+	// subPath from MountSignFormatter::FormatLogSubPath, line from FormatText
+	void Write(const FString& dir, FStringView subPath, FStringView line);
+
+private:
+	struct FolderLog
+	{
+		// <root>/<sub path>
+		FString LogDir;
+		// The user's file, empty until the folder has one
+		FString File;
+	};
+
+	// Older files may be UTF-16 or end without a line break, the one found is rewritten so lines can be appended
+	void findFile(FolderLog& log) const;
+	// False if the file could not be written, it may have been renamed from another machine
+	bool appendLine(FolderLog& log, FStringView line);
+
+	FString mRoot;
+	FString mUserName;
+	TArray<FolderLog> mLogs;
+	// Mount dir - index in mLogs
+	TMap<FString, int32> mDirLogs;
+	// Log dir - index in mLogs, mount dirs with the same sub path share one file
+	TMap<FString, int32> mLogDirs;
+	// Grown to the longest line seen, then reused
+	TArray<TCHAR> mNewFile;
+	TArray<ANSICHAR> mBytes;
+};
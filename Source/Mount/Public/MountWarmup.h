@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "AssetData.h"
+
+struct MountWarmupSettings
+{
+	int32 MaxConcurrency = 4;
+	// Shared by all warm-up reads, 0 for no cap
+	int64 MaxBytesPerSecond = 32ll * 1024 * 1024;
+	// Leading bytes read of each .uasset/.umap. The summary, asset registry data and thumbnails
+	// all live in the header, which with split exports is the whole .uasset.
+	int64 HeaderBytes = 256 * 1024;
+};
+
+// Pulls package headers of freshly mounted folders into the OS and share caches so the registry scan
+// and thumbnail rendering that follow don't wait on the share. Reads bypass the mount cache, which
+// would fetch whole packages regardless of HeaderBytes and the bandwidth cap.
+// Reads run on the pool, at most MaxConcurrency at a time, under a token bucket bandwidth cap.
+class MountWarmup
+{
+public:
+	static MountWarmup& Get();
+	~MountWarmup();
+
+	void Configure(const MountWarmupSettings& settings);
+	bool IsEnabled() const { return bEnabled; }
+	// Mount point - folder, as in MountPlan::Points. Before registering them, so the reads start ahead of the scan.
+	void Enqueue(const TArray<TPair<FString, FString>>& points);
+	void Shutdown();
+
+	void LogStats() const;
+
+private:
+	struct WarmFile
+	{
+		FString File;
+		FName PackageName;
+	};
+
+	void startWorkers();
+	void workerLoop();
+	void listFolder(const TPair<FString, FString>& point);
+	void warmFile(const WarmFile& file, TArray<uint8>& buffer);
+	// Blocks until the bucket has tokens, may leave it in debt for one large request
+	void acquireBandwidth(int64 bytes);
+	void onAssetAdded(const FAssetData& asset);
+	bool isUnderWarmedMount(const FString& packageName) const;
+
+	MountWarmupSettings mSettings;
+	bool bEnabled = false;
+	TAtomic<bool> bStopping{ false };
+
+	mutable FCriticalSection mLock;
+	TArray<TPair<FString, FString>> mPendingFolders;
+	TArray<WarmFile> mPendingFiles;
+	TSet<FName> mWarmPackages;
+	TSet<FString> mMountPoints;
+	int32 mNumWorkers = 0;
+	TArray<TFuture<void>> mWorkers;
+
+	FCriticalSection mBucketLock;
+	double mBucketTokens = 0.0;
+	double mBucketTime = 0.0;
+
+	TAtomic<int32> mNumWarmed{ 0 };
+	TAtomic<int64> mBytesWarmed{ 0 };
+	double mStartTime = 0.0;
+	// Registry discoveries under warmed mounts, game thread
+	int32 mNumDiscovered = 0;
+	int32 mNumDiscoveredWarm = 0;
+	FDelegateHandle mAssetAddedHandle;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Reads which packages a .uasset or .umap imports straight from its header: summary, name table,
+// import table and soft package references, nothing is loaded. Works for packages whose mount point
+// is not registered yet. Safe on any thread.
+class PackageImportReader
+{
+public:
+	// Long package names of the imported packages, and with outSoftPackages of the packages it holds
+	// soft references to, streaming sublevels among them. False if the file is missing or not a
+	// package this engine can read.
+	static bool ReadImportedPackages(const FString& fileName, TArray<FName>& outPackages, TArray<FName>* outSoftPackages = nullptr);
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+// Base for platform file layers the plugin inserts into the chain, forwards everything to the lower level.
+// Subclasses override only the calls they change.
+class PassThroughPlatformFile : public IPlatformFile
+{
+public:
+	virtual bool Initialize(IPlatformFile* Inner, const TCHAR* CmdLine) override
+	{
+		LowerLevel = Inner;
+		return LowerLevel != nullptr;
+	}
+	virtual IPlatformFile* GetLowerLevel() override { return LowerLevel; }
+	virtual void SetLowerLevel(IPlatformFile* NewLowerLevel) override { LowerLevel = NewLowerLevel; }
+
+	virtual bool FileExists(const TCHAR* Filename) override { return LowerLevel->FileExists(Filename); }
+	virtual int64 FileSize(const TCHAR* Filename) override { return LowerLevel->FileSize(Filename); }
+	virtual bool DeleteFile(const TCHAR* Filename) override { return LowerLevel->DeleteFile(Filename); }
+	virtual bool IsReadOnly(const TCHAR* Filename) override { return LowerLevel->IsReadOnly(Filename); }
+	virtual bool MoveFile(const TCHAR* To, const TCHAR* From) override { return LowerLevel->MoveFile(To, From); }
+	virtual bool SetReadOnly(const TCHAR* Filename, bool bNewReadOnlyValue) override { return LowerLevel->SetReadOnly(Filename, bNewReadOnlyValue); }
+	virtual FDateTime GetTimeStamp(const TCHAR* Filename) override { return LowerLevel->GetTimeStamp(Filename); }
+	virtual void SetTimeStamp(const TCHAR* Filename, FDateTime DateTime) override { LowerLevel->SetTimeStamp(Filename, DateTime); }
+	virtual FDateTime GetAccessTimeStamp(const TCHAR* Filename) override { return LowerLevel->GetAccessTimeStamp(Filename); }
+	virtual FString GetFilenameOnDisk(const TCHAR* Filename) override { return LowerLevel->GetFilenameOnDisk(Filename); }
+	virtual IFileHandle* OpenRead(const TCHAR* Filename, bool bAllowWrite = false) override { return LowerLevel->OpenRead(Filename, bAllowWrite); }
+	virtual IFileHandle* OpenWrite(const TCHAR* Filename, bool bAppend = false, bool bAllowRead = false) override { return LowerLevel->OpenWrite(Filename, bAppend, bAllowRead); }
+	// Not forwarding these would put every file in the editor on the generic implementations built on OpenRead
+	virtual IAsyncReadFileHandle* OpenAsyncRead(const TCHAR* Filename) override { return LowerLevel->OpenAsyncRead(Filename); }
+	virtual void SetAsyncMinimumPriority(EAsyncIOPriorityAndFlags MinPriority) override { LowerLevel->SetAsyncMinimumPriority(MinPriority); }
+	virtual IMappedFileHandle* OpenMapped(const TCHAR* Filename) override { return LowerLevel->OpenMapped(Filename); }
+	virtual bool DirectoryExists(const TCHAR* Directory) override { return LowerLevel->DirectoryExists(Directory); }
+	virtual bool CreateDirectory(const TCHAR* Directory) override { return LowerLevel->CreateDirectory(Directory); }
+	virtual bool DeleteDirectory(const TCHAR* Directory) override { return LowerLevel->DeleteDirectory(Directory); }
+	virtual FFileStatData GetStatData(const TCHAR* FilenameOrDirectory) override { return LowerLevel->GetStatData(FilenameOrDirectory); }
+	virtual bool IterateDirectory(const TCHAR* Directory, FDirectoryVisitor& Visitor) override { return LowerLevel->IterateDirectory(Directory, Visitor); }
+	virtual bool IterateDirectoryStat(const TCHAR* Directory, FDirectoryStatVisitor& Visitor) override { return LowerLevel->IterateDirectoryStat(Directory, Visitor); }
+	virtual bool CopyFile(const TCHAR* To, const TCHAR* From, EPlatformFileRead ReadFlags = EPlatformFileRead::None, EPlatformFileWrite WriteFlags = EPlatformFileWrite::None) override
+	{
+		return LowerLevel->CopyFile(To, From, ReadFlags, WriteFlags);
+	}
+
+protected:
+	IPlatformFile* LowerLevel = nullptr;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+struct PluginUpdateFile
+{
+	// Relative to the plugin folder, '/' separated
+	FString Path;
+	int64 Size = 0;
+	// SHA-1
+	FString Hash;
+};
+
+struct PluginUpdateResult
+{
+	bool bSuccess = false;
+	FString Version;
+	int32 NumFiles = 0;
+	int32 NumChanged = 0;
+	// Files of the installed version's manifest the new version no longer has, moved aside with the replaced ones
+	int32 NumRemoved = 0;
+	// Copied from the source by this check, files staged by an earlier check are not copied again
+	int64 CopiedBytes = 0;
+	double Seconds = 0.0;
+	FString Error;
+};
+
+// Updates the plugin from a folder holding a published copy and its manifest.json (path, size and
+// SHA-1 of every file). A check runs on the thread pool: it hashes the installed files (hashes are
+// cached by size and mtime), copies only files that differ into <Plugin>/Saved/Update/Staging and
+// writes pending.json last, with the files the installed version's manifest lists and the new one
+// does not. Files no manifest listed, like local builds, are never removed. The staged files are
+// swapped in by rename when the editor shuts down, replaced and dropped files are renamed to .old
+// and deleted on the next start, when nothing holds them anymore. The applied manifest is kept as
+// Saved/Update/installed.json for the next check.
+class PluginUpdater
+{
+public:
+	static PluginUpdater& Get();
+	~PluginUpdater();
+
+	// onComplete runs on the game thread
+	void CheckAsync(const FString& sourceDir, const FString& pluginDir, TFunction<void(const PluginUpdateResult&)> onComplete);
+	bool IsChecking() const { return mCheck.IsValid() && !mCheck.IsReady(); }
+	// Stops a running check and waits for it and the cleanup, nothing half staged is ever applied
+	void Cancel();
+
+	// Swap in what the last complete check staged. A failed swap is rolled back, the next check stages it again.
+	bool ApplyStaged(const FString& pluginDir);
+	// Delete the .old files of the last apply, on the thread pool
+	void CleanupOldFiles(const FString& pluginDir);
+
+	// Publish a plugin folder as update source, writes its manifest.json
+	static bool WriteManifest(const FString& dir, const FString& version);
+
+	static FString GetStagingDir(const FString& pluginDir);
+	static const TCHAR* ManifestName;
+
+private:
+	PluginUpdateResult check(const FString& sourceDir, const FString& pluginDir);
+
+	TFuture<void> mCheck;
+	TFuture<void> mCleanup;
+	TAtomic<bool> bCancel { false };
+};
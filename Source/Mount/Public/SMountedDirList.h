@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+#include "MountManager.h"
+
+typedef TSharedPtr<MountData> FMountDataPtr;
+typedef TArray<FMountDataPtr> FMountDataList;
+
+DECLARE_DELEGATE_OneParam(FOnMountDataClicked, const MountData&);
+
+// Filterable list of mounted roots for the unmount menu.
+// Rows are virtualized by SListView so opening the menu costs the same for 5 or 500 roots.
+class SMountedDirList : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMountedDirList) {}
+		// Shared with MountManager, only rebuilt when the mount set changes
+		SLATE_ARGUMENT(TSharedPtr<const FMountDataList>, Items)
+		SLATE_EVENT(FOnMountDataClicked, OnItemClicked)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+private:
+	TSharedRef<ITableRow> onGenerateRow(FMountDataPtr item, const TSharedRef<STableViewBase>& ownerTable);
+	void onFilterTextChanged(const FText& text);
+	void onItemClicked(FMountDataPtr item);
+
+	TSharedPtr<const FMountDataList> mItems;
+	FMountDataList mFiltered;
+	FString mFilterText;
+	TSharedPtr<SListView<FMountDataPtr>> mListView;
+	FOnMountDataClicked mOnItemClicked;
+};
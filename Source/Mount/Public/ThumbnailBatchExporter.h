@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetData.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+
+struct ThumbnailExportSettings
+{
+	FString OutputDir;
+	int32 ResolutionX = 256;
+	int32 ResolutionY = 256;
+	int32 Quality = 85;
+	// Game thread time spent rendering per frame
+	double FrameBudgetSeconds = 0.01;
+	// Rendered images waiting for encode/write, caps memory held by the worker pool
+	int32 MaxPendingWrites = 32;
+	// Collect garbage after this many loaded assets
+	int32 GCInterval = 256;
+};
+
+// Exports thumbnails for a whole library: package hashing and jpg encode/write run on the
+// thread pool, rendering runs on the game thread within a frame budget.
+// A manifest in OutputDir remembers source package hashes so unchanged assets are skipped.
+class ThumbnailBatchExporter : public TSharedFromThis<ThumbnailBatchExporter>
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnExportFinished, const ThumbnailBatchExporter&);
+
+	// mountRoot can be a mount point (/Game/Lib/) or a mounted directory on disk
+	static TSharedPtr<ThumbnailBatchExporter> ExportMountRoot(const FString& mountRoot, const ThumbnailExportSettings& settings);
+	static TSharedPtr<ThumbnailBatchExporter> ExportAssets(const TArray<FAssetData>& assets, const ThumbnailExportSettings& settings);
+
+	ThumbnailBatchExporter(const TArray<FAssetData>& assets, const ThumbnailExportSettings& settings);
+	~ThumbnailBatchExporter();
+
+	void Cancel() { bCancelled = true; }
+	bool IsFinished() const { return bFinished; }
+	int32 GetNumExported() const { return mNumExported; }
+	int32 GetNumSkipped() const { return mNumSkipped; }
+	int32 GetNumFailed() const { return mNumFailed; }
+
+	FOnExportFinished OnFinished;
+
+	static const TCHAR* ManifestName;
+
+private:
+	struct ManifestEntry
+	{
+		FString Hash;
+		FString File;
+		int32 ResolutionX = 0;
+		int32 ResolutionY = 0;
+	};
+
+	struct WriteResult
+	{
+		FName ObjectPath;
+		ManifestEntry Entry;
+		bool bSuccess = false;
+	};
+
+	void start();
+	bool tick(float DeltaTime);
+	void hashPackages();
+	void renderOne(int32 index);
+	void drainResults();
+	void finish();
+	void loadManifest();
+	void saveManifest() const;
+	FString outputFileFor(const FAssetData& asset) const;
+
+	ThumbnailExportSettings mSettings;
+	TArray<FAssetData> mAssets;
+	TArray<FString> mFilenames;
+	TArray<FString> mHashes;
+	// Indices into mAssets that need rendering, filled by hashPackages
+	TArray<int32> mRenderQueue;
+	int32 mRenderCursor = 0;
+	int32 mLoadedSinceGC = 0;
+
+	TMap<FName, ManifestEntry> mManifest;
+	TQueue<WriteResult, EQueueMode::Mpsc> mResults;
+	FThreadSafeCounter mPendingWrites;
+
+	TFuture<void> mHashTask;
+	TAtomic<bool> bHashed{ false };
+	TAtomic<bool> bCancelled{ false };
+	bool bFinished = false;
+
+	int32 mNumExported = 0;
+	TAtomic<int32> mNumSkipped{ 0 };
+	int32 mNumFailed = 0;
+	double mStartTime = 0.0;
+};
@@ -18,6 +18,8 @@ public:
 	static Utilities& Get();
 	void PreInit();
 	void Init();
+	// Module shutdown, swaps in a staged plugin update
+	void Shutdown();
 
 	static void Log(const FString& log) { UE_LOG(LogTemp, Log, TEXT("CommonUtility: %s"), *log); };
 	//static void Log(const FName& log) { UE_LOG(LogTemp, Log, TEXT("CommonUtility: %s"), *log.ToString()); };
@@ -35,7 +37,7 @@ public:
 	bool SelectProjectDialog(FString& OutFolderName);
 	bool SelectMultiFilesDialog(const FString& DialogTitle, const FString& FileType, TArray<FString>& OutFileNames);
 	static FString ProjContentDir();
-	static bool CombineActor(TArray<AActor*> Actors, AStaticMeshActor*& OutActor, FString MeshName, FString Path, bool SpawnMesh, bool DestroyReplacedActors);
+	static bool CombineActor(const TArray<AActor*>& Actors, AStaticMeshActor*& OutActor, FString MeshName, FString Path, bool SpawnMesh, bool DestroyReplacedActors);
 	static FString SerializeIndex(int32 inNumber, int32 ZeroNumber);
 
 	// Getters
@@ -52,13 +54,15 @@ public:
 	static void ExportThumbnailJPG(UObject* assetObj, const int32& resolutionX, const int32& resolutionY, const FString& OutputPath);
 
 	// Get FAssetData
-	static void GetAssetsUnderPath(TArray<FName> paths, bool isRecursive, TArray<FAssetData>& OutAssetDatas);
+	static void GetAssetsUnderPath(const TArray<FName>& paths, bool isRecursive, TArray<FAssetData>& OutAssetDatas);
 	static bool GetAssetDataAt(const FString& dataPath, FAssetData& OutAssetData);
+	// One registry query per mount point for the whole batch, OutAssetDatas matches dataPaths index for index
+	static void GetAssetDataAt(const TArray<FString>& dataPaths, TArray<FAssetData>& OutAssetDatas);
 
 	// Copy from ContentBrowserUtils
 	static void GetObjectsInAssetData(const TArray<FAssetData>& AssetList, TArray<UObject*>& OutDroppedObjects);
-	static void MoveAssets(const TArray<UObject*>& Assets, const FString& DestPath, TMap<UObject*, FString> NewNameMap, const FString& SourcePath = FString());
-	static void CopyMetaData(TMap<FName, FString> SourceAndDestPackages);
+	static void MoveAssets(const TArray<UObject*>& Assets, const FString& DestPath, const TMap<UObject*, FString>& NewNameMap, const FString& SourcePath = FString());
+	static void CopyMetaData(const TMap<FName, FString>& SourceAndDestPackages);
 
 	//Separate a Word into char
 	static TArray<FString> SeparateWord(FString word);
@@ -67,7 +71,7 @@ public:
 	static void ShutdownEngine();
 
 	// AdvancedCopy
-	static void AdvancedCopyAssets(const TArray<FAssetData> Assets, const FString& DestPath);
+	static void AdvancedCopyAssets(const TArray<FAssetData>& Assets, const FString& DestPath);
 
 	static FString GetSHA2(FString inPath);
 
@@ -80,7 +84,9 @@ public:
 	FString GetAssetPathPrefixWhenUpload(const FAssetData& inAsset, const FString& libraryName);
 	FString GetLibNameFromSelectedPath(const FString& SelectedPath);
 
-	static void ImportAbc(TArray<FString> FileNames);
+	// Queued through AbcImportQueue into the content browser's current folder
+	static void ImportAbc(const TArray<FString>& FileNames);
+	// One file as static mesh, not saved
 	static void ImportSingleAbc(const FString& InFileName, const FString& OutFilePath);
 
 private:
@@ -96,6 +102,8 @@ private:
 
 	FDelegateHandle mTickDelegateHandle;
 	FTickerDelegate mTickDelegate;
+	// [PluginUpdate] Source
+	FString mUpdateSource;
 	// CommonUtility tools config Dir
 	FString mPluginPath;
 	// Project config file